@@ -634,6 +634,21 @@ namespace graphene { namespace app {
        return result;
     }
 
+    graphene::api_helper_indexes::debt_position_stats asset_api::get_debt_position_stats( std::string asset )const {
+       asset_id_type asset_id = database_api.get_asset_id_from_string( asset );
+       const graphene::api_helper_indexes::amount_in_collateral_index* collateral_index = nullptr;
+       try
+       {
+          collateral_index = &_db.get_index_type< primary_index< call_order_index > >()
+                                .get_secondary_index< graphene::api_helper_indexes::amount_in_collateral_index >();
+       }
+       catch( fc::assert_exception& e )
+       {
+          FC_THROW( "The api_helper_indexes plugin is not enabled" );
+       }
+       return collateral_index->get_debt_position_stats( asset_id );
+    }
+
    // orders_api
    flat_set<uint16_t> orders_api::get_tracked_groups()const
    {
@@ -652,8 +667,6 @@ namespace graphene { namespace app {
       FC_ASSERT( limit <= api_limit_get_grouped_limit_orders );
       auto plugin = _app.get_plugin<graphene::grouped_orders::grouped_orders_plugin>( "grouped_orders" );
       FC_ASSERT( plugin );
-      const auto& limit_groups = plugin->limit_order_groups();
-      vector< limit_order_group > result;
 
       asset_id_type base_asset_id = database_api.get_asset_id_from_string( base_asset );
       asset_id_type quote_asset_id = database_api.get_asset_id_from_string( quote_asset );
@@ -663,14 +676,11 @@ namespace graphene { namespace app {
       if( start.valid() && !start->is_null() )
          max_price = std::max( std::min( max_price, *start ), min_price );
 
-      auto itr = limit_groups.lower_bound( limit_order_group_key( group, max_price ) );
-      // use an end itrator to try to avoid expensive price comparison
-      auto end = limit_groups.upper_bound( limit_order_group_key( group, min_price ) );
-      while( itr != end && result.size() < limit )
-      {
-         result.emplace_back( *itr );
-         ++itr;
-      }
+      const auto groups = plugin->limit_order_groups( base_asset_id, quote_asset_id, group, max_price, limit );
+      vector< limit_order_group > result;
+      result.reserve( groups.size() );
+      for( const auto& g : groups )
+         result.emplace_back( g );
       return result;
    }
 
@@ -428,6 +428,12 @@ void application_impl::startup()
       _chain_db->enable_standby_votes_tracking( _options->at("enable-standby-votes-tracking").as<bool>() );
    }
 
+   if( _options->count("maintenance-profile-history") && _options->count("block-profile-history") )
+   {
+      _chain_db->set_profile_history_size( _options->at("maintenance-profile-history").as<uint32_t>(),
+                                           _options->at("block-profile-history").as<uint32_t>() );
+   }
+
    if( _options->count("replay-blockchain") || _options->count("revalidate-blockchain") )
       _chain_db->wipe( _data_dir / "blockchain", false );
 
@@ -1014,6 +1020,10 @@ void application::set_program_options(boost::program_options::options_descriptio
          ("enable-standby-votes-tracking", bpo::value<bool>()->implicit_value(true),
           "Whether to enable tracking of votes of standby witnesses and committee members. "
           "Set it to true to provide accurate data to API clients, set to false for slightly better performance.")
+         ("maintenance-profile-history", bpo::value<uint32_t>()->default_value(10),
+          "Number of chain maintenance runs to keep phase timings of, 0 to disable")
+         ("block-profile-history", bpo::value<uint32_t>()->default_value(100),
+          "Number of blocks to keep timings of the housekeeping after their transactions of, 0 to disable")
          ("api-limit-get-account-history-operations",boost::program_options::value<uint64_t>()->default_value(100),
           "For history_api::get_account_history_operations to set its default limit value as 100")
          ("api-limit-get-account-history",boost::program_options::value<uint64_t>()->default_value(100),
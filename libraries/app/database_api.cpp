@@ -83,6 +83,24 @@ database_api_impl::database_api_impl( graphene::chain::database& db, const appli
    {
       amount_in_collateral_index = nullptr;
    }
+   try
+   {
+      order_book_cache_index = &_db.get_index_type< primary_index< limit_order_index > >()
+                                  .get_secondary_index<graphene::api_helper_indexes::order_book_cache_index>();
+   }
+   catch( fc::assert_exception& e )
+   {
+      order_book_cache_index = nullptr;
+   }
+   try
+   {
+      market_depth_index = &_db.get_index_type< primary_index< limit_order_index > >()
+                              .get_secondary_index<graphene::api_helper_indexes::market_depth_index>();
+   }
+   catch( fc::assert_exception& e )
+   {
+      market_depth_index = nullptr;
+   }
 }
 
 database_api_impl::~database_api_impl()
@@ -188,7 +206,10 @@ void database_api_impl::cancel_all_subscriptions( bool reset_callback, bool rese
       _subscribe_callback = std::function<void(const fc::variant&)>();
 
    if ( reset_market_subscriptions )
+   {
       _market_subscriptions.clear();
+      _market_depth_subscriptions.clear();
+   }
 
    _notify_remove_create = false;
    _subscribed_accounts.clear();
@@ -318,6 +339,36 @@ dynamic_global_property_object database_api_impl::get_dynamic_global_properties(
    return _db.get(dynamic_global_property_id_type());
 }
 
+vector<execution_profile> database_api::get_maintenance_profiles( uint32_t limit )const
+{
+   return my->get_maintenance_profiles( limit );
+}
+
+vector<execution_profile> database_api_impl::get_maintenance_profiles( uint32_t limit )const
+{
+   return _db.get_maintenance_profiler().get_profiles( limit );
+}
+
+vector<execution_profile> database_api::get_block_profiles( uint32_t limit )const
+{
+   return my->get_block_profiles( limit );
+}
+
+vector<execution_profile> database_api_impl::get_block_profiles( uint32_t limit )const
+{
+   return _db.get_block_profiler().get_profiles( limit );
+}
+
+budget_simulation database_api::simulate_budget()const
+{
+   return my->simulate_budget();
+}
+
+budget_simulation database_api_impl::simulate_budget()const
+{
+   return _db.simulate_budget();
+}
+
 //////////////////////////////////////////////////////////////////////
 //                                                                  //
 // Keys                                                             //
@@ -1173,18 +1224,10 @@ vector<call_order_object> database_api_impl::get_margin_positions( const std::st
 {
    try
    {
-      const auto& idx = _db.get_index_type<call_order_index>();
-      const auto& aidx = idx.indices().get<by_account>();
+      const auto& aidx = _db.get_index_type<call_order_index>().indices().get<by_account>();
       const account_id_type id = get_account_from_string(account_id_or_name)->id;
-      auto start = aidx.lower_bound( boost::make_tuple( id, asset_id_type(0) ) );
-      auto end = aidx.lower_bound( boost::make_tuple( id+1, asset_id_type(0) ) );
-      vector<call_order_object> result;
-      while( start != end )
-      {
-         result.push_back(*start);
-         ++start;
-      }
-      return result;
+      auto range = aidx.equal_range( id );
+      return vector<call_order_object>( range.first, range.second );
    } FC_CAPTURE_AND_RETHROW( (account_id_or_name) )
 }
 
@@ -1253,6 +1296,61 @@ void database_api_impl::unsubscribe_from_market(const std::string& a, const std:
    _market_subscriptions.erase(std::make_pair(asset_a_id,asset_b_id));
 }
 
+market_depth database_api::get_market_depth( const string& base, const string& quote, unsigned limit )const
+{
+   return my->get_market_depth( base, quote, limit );
+}
+
+market_depth database_api_impl::get_market_depth( const string& base, const string& quote, unsigned limit )const
+{
+   FC_ASSERT( market_depth_index, "api_helper_indexes plugin is not enabled on this server." );
+   FC_ASSERT( limit <= _app_options->api_limit_get_order_book );
+
+   market_depth result;
+   result.base = get_asset_from_string( base )->id;
+   result.quote = get_asset_from_string( quote )->id;
+   FC_ASSERT( result.base != result.quote );
+   result.sequence = market_depth_index->get_sequence( result.base, result.quote );
+   result.block_num = market_depth_index->get_published_block_num();
+
+   const auto& bids = market_depth_index->get_published_levels( result.base, result.quote );
+   for( auto itr = bids.begin(); itr != bids.end() && result.bids.size() < limit; ++itr )
+      result.bids.push_back( market_depth_level{ itr->first, itr->second } );
+   const auto& asks = market_depth_index->get_published_levels( result.quote, result.base );
+   for( auto itr = asks.begin(); itr != asks.end() && result.asks.size() < limit; ++itr )
+      result.asks.push_back( market_depth_level{ itr->first, itr->second } );
+
+   return result;
+}
+
+void database_api::subscribe_to_market_depth( std::function<void(const variant&)> callback,
+                                              const string& base, const string& quote )
+{
+   my->subscribe_to_market_depth( callback, base, quote );
+}
+
+void database_api_impl::subscribe_to_market_depth( std::function<void(const variant&)> callback,
+                                                   const string& base, const string& quote )
+{
+   FC_ASSERT( market_depth_index, "api_helper_indexes plugin is not enabled on this server." );
+   auto base_id = get_asset_from_string( base )->id;
+   auto quote_id = get_asset_from_string( quote )->id;
+   FC_ASSERT( base_id != quote_id );
+   _market_depth_subscriptions[ std::make_pair( base_id, quote_id ) ] = callback;
+}
+
+void database_api::unsubscribe_from_market_depth( const string& base, const string& quote )
+{
+   my->unsubscribe_from_market_depth( base, quote );
+}
+
+void database_api_impl::unsubscribe_from_market_depth( const string& base, const string& quote )
+{
+   auto base_id = get_asset_from_string( base )->id;
+   auto quote_id = get_asset_from_string( quote )->id;
+   _market_depth_subscriptions.erase( std::make_pair( base_id, quote_id ) );
+}
+
 market_ticker database_api::get_ticker( const string& base, const string& quote )const
 {
     return my->get_ticker( base, quote );
@@ -1326,30 +1424,51 @@ order_book database_api_impl::get_order_book( const string& base, const string&
 
    auto base_id = assets[0]->id;
    auto quote_id = assets[1]->id;
-   auto orders = get_limit_orders( base_id, quote_id, limit );
 
-   for( const auto& o : orders )
+   using market_orders = graphene::api_helper_indexes::order_book_cache_index::market_orders;
+   std::shared_ptr<const market_orders> orders;
+   if( order_book_cache_index )
+      orders = order_book_cache_index->find_order_book( base_id, quote_id, limit );
+   if( !orders )
    {
-      if( o.sell_price.base.asset_id == base_id )
-      {
-         order ord;
-         ord.price = price_to_string( o.sell_price, *assets[0], *assets[1] );
-         ord.quote = assets[1]->amount_to_string( share_type( fc::uint128_t( o.for_sale.value )
-                                                              * o.sell_price.quote.amount.value
-                                                              / o.sell_price.base.amount.value ) );
-         ord.base = assets[0]->amount_to_string( o.for_sale );
-         result.bids.push_back( ord );
-      }
-      else
+      auto fetched = std::make_shared<market_orders>();
+      for( auto& o : get_limit_orders( base_id, quote_id, limit ) )
       {
-         order ord;
-         ord.price = price_to_string( o.sell_price, *assets[0], *assets[1] );
-         ord.quote = assets[1]->amount_to_string( o.for_sale );
-         ord.base = assets[0]->amount_to_string( share_type( fc::uint128_t( o.for_sale.value )
-                                                             * o.sell_price.quote.amount.value
-                                                             / o.sell_price.base.amount.value ) );
-         result.asks.push_back( ord );
+         if( o.sell_price.base.asset_id == base_id )
+            fetched->bids.push_back( std::move( o ) );
+         else
+            fetched->asks.push_back( std::move( o ) );
       }
+      if( order_book_cache_index )
+         order_book_cache_index->store_order_book( base_id, quote_id, limit, fetched );
+      orders = std::move( fetched );
+   }
+
+   // cached orders may contain more orders than requested
+   const size_t bid_count = std::min<size_t>( limit, orders->bids.size() );
+   for( size_t i = 0; i < bid_count; ++i )
+   {
+      const limit_order_object& o = orders->bids[i];
+      order ord;
+      ord.price = price_to_string( o.sell_price, *assets[0], *assets[1] );
+      ord.quote = assets[1]->amount_to_string( share_type( fc::uint128_t( o.for_sale.value )
+                                                           * o.sell_price.quote.amount.value
+                                                           / o.sell_price.base.amount.value ) );
+      ord.base = assets[0]->amount_to_string( o.for_sale );
+      result.bids.push_back( ord );
+   }
+
+   const size_t ask_count = std::min<size_t>( limit, orders->asks.size() );
+   for( size_t i = 0; i < ask_count; ++i )
+   {
+      const limit_order_object& o = orders->asks[i];
+      order ord;
+      ord.price = price_to_string( o.sell_price, *assets[0], *assets[1] );
+      ord.quote = assets[1]->amount_to_string( o.for_sale );
+      ord.base = assets[0]->amount_to_string( share_type( fc::uint128_t( o.for_sale.value )
+                                                          * o.sell_price.quote.amount.value
+                                                          / o.sell_price.base.amount.value ) );
+      result.asks.push_back( ord );
    }
 
    return result;
@@ -1374,8 +1493,8 @@ vector<market_ticker> database_api_impl::get_top_markets(uint32_t limit)const
 
    while( itr != volume_idx.rend() && result.size() < limit)
    {
-      const asset_object base = itr->base(_db);
-      const asset_object quote = itr->quote(_db);
+      const asset_object& base = itr->base(_db);
+      const asset_object& quote = itr->quote(_db);
       order_book orders;
       orders = get_order_book(base.symbol, quote.symbol, 1);
 
@@ -2412,30 +2531,21 @@ vector<limit_order_object> database_api_impl::get_limit_orders( const asset_id_t
    uint64_t api_limit_get_limit_orders=_app_options->api_limit_get_limit_orders;
    FC_ASSERT( limit <= api_limit_get_limit_orders );
 
-   const auto& limit_order_idx = _db.get_index_type<limit_order_index>();
-   const auto& limit_price_idx = limit_order_idx.indices().get<by_price>();
+   const auto& order_books = _db.get_index_type< primary_index< limit_order_index > >()
+                                .get_secondary_index< limit_order_book_index >();
 
    vector<limit_order_object> result;
    result.reserve(limit*2);
 
    uint32_t count = 0;
-   auto limit_itr = limit_price_idx.lower_bound(price::max(a,b));
-   auto limit_end = limit_price_idx.upper_bound(price::min(a,b));
-   while(limit_itr != limit_end && count < limit)
-   {
-      result.push_back(*limit_itr);
-      ++limit_itr;
-      ++count;
-   }
+   const auto& a_side = order_books.get_orders(a,b);
+   for( auto limit_itr = a_side.begin(); limit_itr != a_side.end() && count < limit; ++limit_itr, ++count )
+      result.push_back(*limit_itr->second);
+
    count = 0;
-   limit_itr = limit_price_idx.lower_bound(price::max(b,a));
-   limit_end = limit_price_idx.upper_bound(price::min(b,a));
-   while(limit_itr != limit_end && count < limit)
-   {
-      result.push_back(*limit_itr);
-      ++limit_itr;
-      ++count;
-   }
+   const auto& b_side = order_books.get_orders(b,a);
+   for( auto limit_itr = b_side.begin(); limit_itr != b_side.end() && count < limit; ++limit_itr, ++count )
+      result.push_back(*limit_itr->second);
 
    return result;
 }
@@ -2584,6 +2694,44 @@ void database_api_impl::on_applied_block()
       });
    }
 
+   // the depth updates are published by the api_helper_indexes plugin, which is notified first
+   if( !_market_depth_subscriptions.empty() && market_depth_index
+         && market_depth_index->get_published_block_num() == _db.head_block_num() )
+   {
+      vector< pair< pair<asset_id_type,asset_id_type>, market_depth > > depth_queue;
+      for( const auto& update : market_depth_index->get_published_updates() )
+      {
+         for( const auto& market : { update.market, std::make_pair( update.market.second, update.market.first ) } )
+         {
+            if( !_market_depth_subscriptions.count( market ) )
+               continue;
+            market_depth depth;
+            depth.base = market.first;
+            depth.quote = market.second;
+            depth.sequence = update.sequence;
+            depth.block_num = market_depth_index->get_published_block_num();
+            for( const auto& level : update.levels )
+            {
+               auto& side = ( level.first.base.asset_id == market.first ? depth.bids : depth.asks );
+               side.push_back( market_depth_level{ level.first, level.second } );
+            }
+            depth_queue.emplace_back( market, std::move( depth ) );
+         }
+      }
+      if( !depth_queue.empty() )
+      {
+         auto capture_this = shared_from_this();
+         fc::async([this,capture_this,depth_queue](){
+            for( const auto& item : depth_queue )
+            {
+               auto sub = _market_depth_subscriptions.find( item.first );
+               if( sub != _market_depth_subscriptions.end() )
+                  sub->second( fc::variant( item.second, GRAPHENE_MAX_NESTED_OBJECTS ) );
+            }
+         });
+      }
+   }
+
    if(_market_subscriptions.size() == 0)
       return;
 
@@ -61,6 +61,9 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       fc::variant_object get_config()const;
       chain_id_type get_chain_id()const;
       dynamic_global_property_object get_dynamic_global_properties()const;
+      vector<execution_profile> get_maintenance_profiles( uint32_t limit )const;
+      vector<execution_profile> get_block_profiles( uint32_t limit )const;
+      budget_simulation simulate_budget()const;
 
       // Keys
       vector<flat_set<account_id_type>> get_key_references( vector<public_key_type> key )const;
@@ -120,6 +123,10 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       void subscribe_to_market( std::function<void(const variant&)> callback,
                                 const std::string& a, const std::string& b );
       void unsubscribe_from_market(const std::string& a, const std::string& b);
+      market_depth get_market_depth( const string& base, const string& quote, unsigned limit )const;
+      void subscribe_to_market_depth( std::function<void(const variant&)> callback,
+                                      const string& base, const string& quote );
+      void unsubscribe_from_market_depth( const string& base, const string& quote );
 
       market_ticker                      get_ticker( const string& base, const string& quote,
                                                      bool skip_order_book = false )const;
@@ -356,11 +363,15 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       boost::signals2::scoped_connection _pending_trx_connection;
 
       map< pair<asset_id_type,asset_id_type>, std::function<void(const variant&)> > _market_subscriptions;
+      /// Depth subscriptions by (base, quote)
+      map< pair<asset_id_type,asset_id_type>, std::function<void(const variant&)> > _market_depth_subscriptions;
 
       graphene::chain::database& _db;
       const application_options* _app_options = nullptr;
 
       const graphene::api_helper_indexes::amount_in_collateral_index* amount_in_collateral_index;
+      const graphene::api_helper_indexes::order_book_cache_index* order_book_cache_index;
+      const graphene::api_helper_indexes::market_depth_index* market_depth_index;
 };
 
 } } // graphene::app
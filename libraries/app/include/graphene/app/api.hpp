@@ -476,6 +476,14 @@ namespace graphene { namespace app {
           */
          vector<asset_holders> get_all_asset_holders() const;
 
+         /**
+          * @brief Get the total debt, total collateral and number of debt positions of an MPA.
+          *        Needs the api_helper_indexes plugin.
+          * @param asset The MPA id or symbol
+          * @return The aggregated debt positions of the MPA, all zero for other assets
+          */
+         graphene::api_helper_indexes::debt_position_stats get_debt_position_stats( std::string asset )const;
+
       private:
          graphene::app::application& _app;
          graphene::chain::database& _db;
@@ -645,6 +653,7 @@ FC_API(graphene::app::asset_api,
        (get_asset_holders)
 	   (get_asset_holders_count)
        (get_all_asset_holders)
+       (get_debt_position_stats)
      )
 FC_API(graphene::app::orders_api,
        (get_tracked_groups)
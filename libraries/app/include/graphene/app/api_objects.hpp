@@ -93,6 +93,22 @@ namespace graphene { namespace app {
      vector< order >             asks;
    };
 
+   struct market_depth_level
+   {
+      price                      sell_price;
+      share_type                 for_sale;
+   };
+
+   struct market_depth
+   {
+      asset_id_type              base;
+      asset_id_type              quote;
+      uint64_t                   sequence = 0;   ///< number of updates published for the market so far
+      uint32_t                   block_num = 0;  ///< the block the depth was published with
+      vector< market_depth_level > bids;         ///< levels selling the base asset
+      vector< market_depth_level > asks;         ///< levels selling the quote asset
+   };
+
    struct market_ticker
    {
       time_point_sec             time;
@@ -177,6 +193,8 @@ FC_REFLECT( graphene::app::full_account,
 
 FC_REFLECT( graphene::app::order, (price)(quote)(base) );
 FC_REFLECT( graphene::app::order_book, (base)(quote)(bids)(asks) );
+FC_REFLECT( graphene::app::market_depth_level, (sell_price)(for_sale) );
+FC_REFLECT( graphene::app::market_depth, (base)(quote)(sequence)(block_num)(bids)(asks) );
 FC_REFLECT( graphene::app::market_ticker,
             (time)(base)(quote)(latest)(lowest_ask)(highest_bid)(percent_change)(base_volume)(quote_volume) );
 FC_REFLECT( graphene::app::market_volume, (time)(base)(quote)(base_volume)(quote_volume) );
@@ -30,6 +30,7 @@
 #include <graphene/chain/database.hpp>
 
 #include <graphene/chain/balance_object.hpp>
+#include <graphene/chain/budget_record_object.hpp>
 #include <graphene/chain/chain_property_object.hpp>
 #include <graphene/chain/committee_member_object.hpp>
 #include <graphene/chain/confidential_object.hpp>
@@ -217,6 +218,29 @@ class database_api
        */
       dynamic_global_property_object get_dynamic_global_properties()const;
 
+      /**
+       * @brief Get the time spent in the phases of the last chain maintenance runs
+       * @param limit Maximum number of runs to return, the node keeps as many as configured
+       * @return Profiles of the maintenance runs, most recent first
+       */
+      vector<execution_profile> get_maintenance_profiles( uint32_t limit = 10 )const;
+
+      /**
+       * @brief Get the time spent in the housekeeping of the last blocks, after their transactions were applied
+       * @param limit Maximum number of blocks to return, the node keeps as many as configured
+       * @return Profiles of the blocks, most recent first
+       */
+      vector<execution_profile> get_block_profiles( uint32_t limit = 100 )const;
+
+      /**
+       * @brief Compute the budget of the next maintenance and the pay each worker would get, as of the current state
+       * @return The simulated budget record and the pay of the workers, in the order they would be paid
+       *
+       * Nothing is changed on the chain. Votes and fees are taken as they are now, so the result may differ from
+       * the actual budget if they change before the next maintenance.
+       */
+      budget_simulation simulate_budget()const;
+
       //////////
       // Keys //
       //////////
@@ -535,6 +559,40 @@ class database_api
        */
       void unsubscribe_from_market( const std::string& a, const std::string& b );
 
+      /**
+       * @brief Returns the limit orders of the market base:quote aggregated by price
+       * @param base symbol name or ID of the base asset
+       * @param quote symbol name or ID of the quote asset
+       * @param limit number of price levels to retrieve, for bids and asks each, capped at 50
+       * @return The price levels as published with the last block, best first
+       *
+       * Needs the api_helper_indexes plugin. Used to start or resynchronize a
+       * @ref subscribe_to_market_depth subscription: updates with a sequence number up to the one of the
+       * returned depth are already included in it.
+       */
+      market_depth get_market_depth( const string& base, const string& quote, unsigned limit = 50 )const;
+
+      /**
+       * @brief Request the price levels of a market that changed with every block
+       * @param callback Callback method which is called with the changes of every block
+       * @param base symbol name or ID of the base asset
+       * @param quote symbol name or ID of the quote asset
+       *
+       * Callback will be passed a variant containing a market_depth object with the changed levels only,
+       * a level with nothing for sale has been removed. The sequence number of the market is increased by one
+       * with every update, a gap means that an update was missed and @ref get_market_depth needs to be called
+       * again. Needs the api_helper_indexes plugin.
+       */
+      void subscribe_to_market_depth( std::function<void(const variant&)> callback,
+                                      const string& base, const string& quote );
+
+      /**
+       * @brief Unsubscribe from depth updates of a given market
+       * @param base symbol name or ID of the base asset
+       * @param quote symbol name or ID of the quote asset
+       */
+      void unsubscribe_from_market_depth( const string& base, const string& quote );
+
       /**
        * @brief Returns the ticker for the market assetA:assetB
        * @param base symbol name or ID of the base asset
@@ -919,6 +977,9 @@ FC_API(graphene::app::database_api,
    (get_config)
    (get_chain_id)
    (get_dynamic_global_properties)
+   (get_maintenance_profiles)
+   (get_block_profiles)
+   (simulate_budget)
 
    // Keys
    (get_key_references)
@@ -961,6 +1022,9 @@ FC_API(graphene::app::database_api,
    (get_collateral_bids)
    (subscribe_to_market)
    (unsubscribe_from_market)
+   (get_market_depth)
+   (subscribe_to_market_depth)
+   (unsubscribe_from_market_depth)
    (get_ticker)
    (get_24_volume)
    (get_top_markets)
@@ -340,6 +340,9 @@ void_result account_update_evaluator::do_apply( const account_update_operation&
       }
    });
 
+   if( o.owner || o.active )
+      d.invalidate_cached_authorities( o.account );
+
    bool sa_after = acnt->has_special_authority();
 
    if( sa_before && (!sa_after) )
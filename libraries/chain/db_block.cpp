@@ -40,6 +40,7 @@
 
 #include <fc/io/raw.hpp>
 #include <fc/thread/parallel.hpp>
+#include <fc/uint128.hpp>
 
 namespace graphene { namespace chain {
 
@@ -226,7 +227,8 @@ bool database::_push_block(const signed_block& new_block)
 processed_transaction database::push_transaction( const precomputable_transaction& trx, uint32_t skip )
 { try {
    // see https://github.com/bitshares/bitshares-core/issues/1573
-   FC_ASSERT( fc::raw::pack_size( trx ) < (1024 * 1024), "Transaction exceeds maximum transaction size." );
+   FC_ASSERT( trx.get_packed_size() + fc::raw::pack_size( trx.signatures ) < (1024 * 1024),
+              "Transaction exceeds maximum transaction size." );
    processed_transaction result;
    detail::with_skip_flags( *this, skip, [&]()
    {
@@ -284,6 +286,24 @@ private:
     uint32_t& counter;
 };
 
+/// Sets up an authority check cache if enabled, and drops it when leaving the scope, also if an exception is thrown
+class authority_check_cache_guard {
+public:
+   authority_check_cache_guard( optional<authority_check_cache>& cache, const database& db, bool enabled )
+      : _cache(cache)
+   {
+      if( enabled )
+         _cache = authority_check_cache( [&db]( account_id_type id ) { return &id(db).active; },
+                                         [&db]( account_id_type id ) { return &id(db).owner;  } );
+   }
+   ~authority_check_cache_guard()
+   {
+      _cache.reset();
+   }
+private:
+   optional<authority_check_cache>& _cache;
+};
+
 processed_transaction database::push_proposal(const proposal_object& proposal)
 { try {
    transaction_evaluation_state eval_state(this);
@@ -324,6 +344,115 @@ processed_transaction database::push_proposal(const proposal_object& proposal)
    return ptrx;
 } FC_CAPTURE_AND_RETHROW( (proposal) ) }
 
+namespace {
+
+struct fee_payer_visitor
+{
+   typedef account_id_type result_type;
+
+   template<typename OpType>
+   account_id_type operator()( const OpType& op )const { return op.fee_payer(); }
+};
+
+struct fee_visitor
+{
+   typedef asset result_type;
+
+   template<typename OpType>
+   asset operator()( const OpType& op )const { return op.fee; }
+};
+
+flat_set<account_id_type> get_fee_payers( const transaction& tx )
+{
+   flat_set<account_id_type> payers;
+   for( const auto& op : tx.operations )
+      payers.insert( op.visit( fee_payer_visitor() ) );
+   return payers;
+}
+
+} // anonymous namespace
+
+vector<size_t> database::order_by_arrival( const database& db, const vector<processed_transaction>& trxs )
+{
+   vector<size_t> order( trxs.size() );
+   for( size_t i = 0; i < order.size(); ++i )
+      order[i] = i;
+   return order;
+}
+
+vector<size_t> database::order_by_fee_per_byte( const database& db, const vector<processed_transaction>& trxs )
+{
+   struct candidate
+   {
+      fc::uint128_t   fee;
+      fc::uint128_t   size;
+      /// number of earlier transactions of the same fee payers which are not ordered yet
+      uint32_t        waiting_for = 0;
+      /// later transactions which share a fee payer with this one
+      vector<size_t>  successors;
+   };
+
+   // A transaction has to wait for the last earlier transaction of each of its fee payers
+   const fee_schedule& fees = db.current_fee_schedule();
+   vector<candidate> candidates( trxs.size() );
+   flat_map< account_id_type, size_t > last_of_payer;
+   for( size_t i = 0; i < trxs.size(); ++i )
+   {
+      candidate& c = candidates[i];
+      c.size = trxs[i].get_full_packed_size();
+      for( const auto& op : trxs[i].operations )
+         c.fee += uint64_t( fees.calculate_fee( op ).amount.value );
+      flat_set<size_t> predecessors;
+      for( const account_id_type& payer : get_fee_payers( trxs[i] ) )
+      {
+         auto itr = last_of_payer.find( payer );
+         if( itr != last_of_payer.end() )
+         {
+            predecessors.insert( itr->second );
+            itr->second = i;
+         }
+         else
+            last_of_payer.emplace( payer, i );
+      }
+      for( size_t p : predecessors )
+         candidates[p].successors.push_back( i );
+      c.waiting_for = predecessors.size();
+   }
+
+   // Repeatedly take the transaction paying most per byte among those which are not waiting for others
+   auto lower_priority = [&candidates]( size_t a, size_t b ) {
+      const fc::uint128_t pa = candidates[a].fee * candidates[b].size;
+      const fc::uint128_t pb = candidates[b].fee * candidates[a].size;
+      if( pa != pb )
+         return pa < pb;
+      return a > b;
+   };
+   vector<size_t> heap;
+   for( size_t i = 0; i < candidates.size(); ++i )
+      if( candidates[i].waiting_for == 0 )
+         heap.push_back( i );
+   std::make_heap( heap.begin(), heap.end(), lower_priority );
+
+   vector<size_t> order;
+   order.reserve( trxs.size() );
+   while( !heap.empty() )
+   {
+      std::pop_heap( heap.begin(), heap.end(), lower_priority );
+      const size_t next = heap.back();
+      heap.pop_back();
+      order.push_back( next );
+      for( size_t s : candidates[next].successors )
+      {
+         if( --candidates[s].waiting_for == 0 )
+         {
+            heap.push_back( s );
+            std::push_heap( heap.begin(), heap.end(), lower_priority );
+         }
+      }
+   }
+   return order;
+}
+
 signed_block database::generate_block(
    fc::time_point_sec when,
    witness_id_type witness_id,
@@ -390,15 +519,43 @@ signed_block database::_generate_block(
 
    _pending_tx_session = _undo_db.start_undo_session();
 
-   uint64_t postponed_tx_count = 0;
-   for( const processed_transaction& tx : _pending_tx )
+   block_assembly_stats stats;
+   stats.candidates = _pending_tx.size();
+   stats.maximum_block_size = maximum_block_size;
+
+   // When the strategy reorders transactions, the later transactions of the fee payers of a postponed
+   // transaction are postponed as well, so that they are not included before it
+   flat_set<account_id_type> postponed_payers;
+   auto postpone = [this,&postponed_payers]( const flat_set<account_id_type>& payers ) {
+      if( _keep_fee_payer_order )
+         postponed_payers.insert( payers.begin(), payers.end() );
+   };
+   const vector<size_t> order = _block_assembly_strategy( *this, _pending_tx );
+   for( size_t i : order )
    {
-      size_t new_total_size = total_block_size + fc::raw::pack_size( tx );
+      const processed_transaction& tx = _pending_tx[i];
+      flat_set<account_id_type> payers;
+      if( _keep_fee_payer_order )
+      {
+         payers = get_fee_payers( tx );
+         if( std::any_of( payers.begin(), payers.end(), [&postponed_payers]( const account_id_type& payer ) {
+                            return postponed_payers.find( payer ) != postponed_payers.end();
+                         } ) )
+         {
+            // all payers have to wait, a later transaction of another payer may depend on this one
+            postpone( payers );
+            stats.postponed_by_payer++;
+            continue;
+         }
+      }
+
+      size_t new_total_size = total_block_size + tx.get_full_packed_size();
 
       // postpone transaction if it would make block too big
       if( new_total_size > maximum_block_size )
       {
-         postponed_tx_count++;
+         postpone( payers );
+         stats.postponed_by_size++;
          continue;
       }
 
@@ -410,30 +567,46 @@ signed_block database::_generate_block(
          // We have to recompute pack_size(ptx) because it may be different
          // than pack_size(tx) (i.e. if one or more results increased
          // their size)
-         new_total_size = total_block_size + fc::raw::pack_size( ptx );
+         new_total_size = total_block_size + ptx.get_full_packed_size();
          // postpone transaction if it would make block too big
          if( new_total_size > maximum_block_size )
          {
-            postponed_tx_count++;
+            postpone( payers );
+            stats.postponed_by_size++;
             continue;
          }
 
          temp_session.merge();
 
          total_block_size = new_total_size;
+         stats.included++;
+         for( const auto& op : ptx.operations )
+         {
+            const asset fee = op.visit( fee_visitor() );
+            if( fee.asset_id == asset_id_type() )
+               stats.fees += fee.amount.value;
+         }
          pending_block.transactions.push_back( ptx );
       }
       catch ( const fc::exception& e )
       {
          // Do nothing, transaction will not be re-applied
+         stats.failed++;
          wlog( "Transaction was not processed while generating block due to ${e}", ("e", e) );
          wlog( "The transaction was ${t}", ("t", tx) );
       }
    }
-   if( postponed_tx_count > 0 )
+   if( stats.postponed_by_size > 0 )
    {
-      wlog( "Postponed ${n} transactions due to block size limit", ("n", postponed_tx_count) );
+      wlog( "Postponed ${n} transactions due to block size limit", ("n", stats.postponed_by_size) );
    }
+   if( stats.postponed_by_payer > 0 )
+   {
+      wlog( "Postponed ${n} transactions behind postponed transactions of their fee payers",
+            ("n", stats.postponed_by_payer) );
+   }
+   stats.block_size = total_block_size;
+   _last_block_assembly_stats = stats;
 
    _pending_tx_session.reset();
 
@@ -539,7 +712,7 @@ void database::_apply_block( const signed_block& next_block )
 
    if( !(skip & skip_block_size_check) )
    {
-      FC_ASSERT( fc::raw::pack_size(next_block) <= get_global_properties().parameters.maximum_block_size );
+      FC_ASSERT( next_block.get_packed_size() <= get_global_properties().parameters.maximum_block_size );
    }
 
    FC_ASSERT( (skip & skip_merkle_check) || next_block.transaction_merkle_root == next_block.calculate_merkle_root(),
@@ -565,38 +738,59 @@ void database::_apply_block( const signed_block& next_block )
 
    _issue_453_affected_assets.clear();
 
-   for( const auto& trx : next_block.transactions )
    {
-      /* We do not need to push the undo state for each transaction
-       * because they either all apply and are valid or the
-       * entire block fails to apply.  We only need an "undo" state
-       * for transactions when validating broadcast transactions or
-       * when building a block.
-       */
-      apply_transaction( trx, skip );
-      ++_current_trx_in_block;
+      // Authorities of accounts and authority check results are reused by all transactions in the block
+      authority_check_cache_guard auth_cache_guard( _authority_check_cache, *this,
+                                                    !(skip & skip_transaction_signatures) );
+
+      for( const auto& trx : next_block.transactions )
+      {
+         /* We do not need to push the undo state for each transaction
+          * because they either all apply and are valid or the
+          * entire block fails to apply.  We only need an "undo" state
+          * for transactions when validating broadcast transactions or
+          * when building a block.
+          */
+         apply_transaction( trx, skip );
+         ++_current_trx_in_block;
+      }
    }
 
    _current_op_in_trx    = 0;
    _current_virtual_op   = 0;
 
-   const uint32_t missed = update_witness_missed_blocks( next_block );
-   update_global_dynamic_data( next_block, missed );
-   update_signing_witness(signing_witness, next_block);
-   update_last_irreversible_block();
+   auto& profiler = _block_profiler;
+   profiler.begin( next_block_num, next_block.timestamp );
+
+   profiler.run_phase( "update_witnesses_and_global_data", [this,&next_block,&signing_witness]() {
+      const uint32_t missed = update_witness_missed_blocks( next_block );
+      update_global_dynamic_data( next_block, missed );
+      update_signing_witness(signing_witness, next_block);
+      update_last_irreversible_block();
+   });
 
    // Are we at the maintenance interval?
    if( maint_needed )
-      perform_chain_maintenance(next_block, global_props);
+      profiler.run_phase( "perform_chain_maintenance", [this,&next_block,&global_props]() {
+         perform_chain_maintenance(next_block, global_props);
+      });
+
+   if( get_dynamic_global_properties().next_fee_processing_account.valid() )
+      profiler.run_phase( "process_deferred_fees", [this]() { process_deferred_fees(); } );
 
    create_block_summary(next_block);
-   clear_expired_transactions();
-   clear_expired_proposals();
-   clear_expired_orders();
-   clear_expired_htlcs();
-   update_expired_feeds();       // this will update expired feeds and some core exchange rates
-   update_core_exchange_rates(); // this will update remaining core exchange rates
-   update_withdraw_permissions();
+
+   profiler.run_phase( "clear_expired_transactions_and_proposals", [this]() {
+      clear_expired_transactions();
+      clear_expired_proposals();
+   });
+   profiler.run_phase( "clear_expired_orders", [this]() { clear_expired_orders(); } );
+   profiler.run_phase( "clear_expired_htlcs", [this]() { clear_expired_htlcs(); } );
+   profiler.run_phase( "update_feeds_and_core_exchange_rates", [this]() {
+      update_expired_feeds();       // this will update expired feeds and some core exchange rates
+      update_core_exchange_rates(); // this will update remaining core exchange rates
+   });
+   profiler.run_phase( "update_withdraw_permissions", [this]() { update_withdraw_permissions(); } );
 
    // n.b., update_maintenance_flag() happens this late
    // because get_slot_time() / get_slot_at_time() is needed above
@@ -604,9 +798,17 @@ void database::_apply_block( const signed_block& next_block )
    // update_global_dynamic_data() as perhaps these methods only need
    // to be called for header validation?
    update_maintenance_flag( maint_needed );
-   update_witness_schedule();
+   profiler.run_phase( "update_witness_schedule", [this]() { update_witness_schedule(); } );
    if( !_node_property_object.debug_updates.empty() )
+   {
       apply_debug_updates();
+      refresh_witness_schedule_cache();
+   }
+
+   const execution_profile* profile = profiler.end();
+   if( profile != nullptr )
+      dlog( "Housekeeping of block ${b} took ${t}us with ${c} object changes",
+            ("b",profile->block_num)("t",profile->microseconds)("c",profile->object_changes) );
 
    // notify observers that the block has been applied
    notify_applied_block( next_block ); //emit
@@ -649,13 +851,21 @@ processed_transaction database::_apply_transaction(const signed_transaction& trx
    if( !(skip & skip_transaction_signatures) )
    {
       bool allow_non_immediate_owner = ( head_block_time() >= HARDFORK_CORE_584_TIME );
-      auto get_active = [&]( account_id_type id ) { return &id(*this).active; };
-      auto get_owner  = [&]( account_id_type id ) { return &id(*this).owner;  };
-      trx.verify_authority( chain_id,
-                            get_active,
-                            get_owner,
-                            allow_non_immediate_owner,
-                            get_global_properties().parameters.max_authority_depth );
+      if( _authority_check_cache.valid() )
+         trx.verify_authority( chain_id,
+                               *_authority_check_cache,
+                               allow_non_immediate_owner,
+                               get_global_properties().parameters.max_authority_depth );
+      else
+      {
+         auto get_active = [&]( account_id_type id ) { return &id(*this).active; };
+         auto get_owner  = [&]( account_id_type id ) { return &id(*this).owner;  };
+         trx.verify_authority( chain_id,
+                               get_active,
+                               get_owner,
+                               allow_non_immediate_owner,
+                               get_global_properties().parameters.max_authority_depth );
+      }
    }
 
    //Skip all manner of expiration and TaPoS checking if we're on block 1; It's impossible that the transaction is
@@ -693,7 +903,11 @@ processed_transaction database::_apply_transaction(const signed_transaction& trx
    eval_state.operation_results.reserve(trx.operations.size());
 
    //Finally process the operations
-   processed_transaction ptrx(trx);
+   // Keep precomputed data (signature keys, serialization etc) if available, so that it does not need
+   // to be computed again when the result is re-applied, e.g. when it is a pending transaction
+   const precomputable_transaction* precomputed = dynamic_cast<const precomputable_transaction*>( &trx );
+   processed_transaction ptrx = ( precomputed != nullptr ? processed_transaction( *precomputed )
+                                                        : processed_transaction( trx ) );
    _current_op_in_trx = 0;
    for( const auto& op : ptrx.operations )
    {
@@ -706,6 +920,12 @@ processed_transaction database::_apply_transaction(const signed_transaction& trx
    return ptrx;
 } FC_CAPTURE_AND_RETHROW( (trx) ) }
 
+void database::invalidate_cached_authorities( account_id_type account )
+{
+   if( _authority_check_cache.valid() )
+      _authority_check_cache->invalidate( account );
+}
+
 operation_result database::apply_operation(transaction_evaluation_state& eval_state, const operation& op)
 { try {
    int i_which = op.which();
@@ -55,6 +55,11 @@ const dynamic_global_property_object& database::get_dynamic_global_properties()
    return *_p_dyn_global_prop_obj;
 }
 
+const hardfork_state& database::get_hardfork_state()const
+{
+   return _hardfork_state_index->get_state();
+}
+
 const fee_schedule&  database::current_fee_schedule()const
 {
    return get_global_properties().parameters.get_current_fees();
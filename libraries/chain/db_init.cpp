@@ -195,8 +195,10 @@ void database::initialize_indexes()
 
    add_index< primary_index<committee_member_index, 8> >(); // 256 members per chunk
    add_index< primary_index<witness_index, 10> >(); // 1024 witnesses per chunk
-   add_index< primary_index<limit_order_index > >();
-   add_index< primary_index<call_order_index > >();
+   auto limit_order_idx = add_index< primary_index<limit_order_index > >();
+   limit_order_idx->add_secondary_index<limit_order_book_index>();
+   auto call_order_idx = add_index< primary_index<call_order_index > >();
+   call_order_idx->add_secondary_index<margin_call_trigger_index>();
 
    auto prop_index = add_index< primary_index<proposal_index > >();
    prop_index->add_secondary_index<required_approval_index>();
@@ -216,7 +218,8 @@ void database::initialize_indexes()
 
    add_index< primary_index<asset_bitasset_data_index,                 13 > >(); // 8192
    add_index< primary_index<simple_index<global_property_object          >> >();
-   add_index< primary_index<simple_index<dynamic_global_property_object  >> >();
+   auto dgpo_idx = add_index< primary_index<simple_index<dynamic_global_property_object  >> >();
+   _hardfork_state_index = dgpo_idx->add_secondary_index<hardfork_state_index>();
    add_index< primary_index<account_stats_index,                       20 > >(); // 1 Mi
    add_index< primary_index<simple_index<asset_dynamic_data_object       >> >();
    add_index< primary_index<simple_index<block_summary_object            >> >();
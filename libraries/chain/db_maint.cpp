@@ -51,28 +51,56 @@ template<class Index>
 vector<std::reference_wrapper<const typename Index::object_type>> database::sort_votable_objects(size_t count) const
 {
    using ObjectType = typename Index::object_type;
+
+   /// A candidate with its votes, so that comparisons don't need to look them up
+   struct candidate
+   {
+      uint64_t          votes;
+      vote_id_type      vote_id;
+      const ObjectType* object;
+   };
+   // more votes first, if two candidates tie the one with lower vote ID is preferred
+   const auto better = []( const candidate& a, const candidate& b ) {
+      if( a.votes != b.votes )
+         return a.votes > b.votes;
+      return a.vote_id < b.vote_id;
+   };
+
    const auto& all_objects = get_index_type<Index>().indices();
    count = std::min(count, all_objects.size());
-   vector<std::reference_wrapper<const ObjectType>> refs;
-   refs.reserve(all_objects.size());
-   std::transform(all_objects.begin(), all_objects.end(),
-                  std::back_inserter(refs),
-                  [](const ObjectType& o) { return std::cref(o); });
-   std::partial_sort(refs.begin(), refs.begin() + count, refs.end(),
-                   [this](const ObjectType& a, const ObjectType& b)->bool {
-      share_type oa_vote = _vote_tally_buffer[a.vote_id];
-      share_type ob_vote = _vote_tally_buffer[b.vote_id];
-      if( oa_vote != ob_vote )
-         return oa_vote > ob_vote;
-      return a.vote_id < b.vote_id;
-   });
 
-   refs.resize(count, refs.front());
+   // keep the best candidates in a heap whose front is the worst of them
+   vector<candidate> top;
+   top.reserve(count);
+   if( count > 0 )
+   {
+      for( const ObjectType& o : all_objects )
+      {
+         candidate c { _vote_tally_buffer[o.vote_id], o.vote_id, &o };
+         if( top.size() < count )
+         {
+            top.push_back( c );
+            std::push_heap( top.begin(), top.end(), better );
+         }
+         else if( better( c, top.front() ) )
+         {
+            std::pop_heap( top.begin(), top.end(), better );
+            top.back() = c;
+            std::push_heap( top.begin(), top.end(), better );
+         }
+      }
+      std::sort_heap( top.begin(), top.end(), better );
+   }
+
+   vector<std::reference_wrapper<const ObjectType>> refs;
+   refs.reserve(count);
+   for( const candidate& c : top )
+      refs.push_back( std::cref( *c.object ) );
    return refs;
 }
 
 template<class Type>
-void database::perform_account_maintenance(Type tally_helper)
+void database::perform_account_maintenance(Type tally_helper, bool process_fees)
 {
    const auto& bal_idx = get_index_type< account_balance_index >().indices().get< by_maintenance_flag >();
    if( bal_idx.begin() != bal_idx.end() )
@@ -106,7 +134,7 @@ void database::perform_account_maintenance(Type tally_helper)
       if( acc_stat.has_some_core_voting() )
          tally_helper( acc_obj, acc_stat );
 
-      if( acc_stat.has_pending_fees() )
+      if( process_fees && acc_stat.has_pending_fees() )
          acc_stat.process_fees( acc_obj, *this );
    }
 
@@ -139,24 +167,30 @@ void database::update_worker_votes()
    bool allow_negative_votes = (head_block_time() < HARDFORK_607_TIME);
    while( itr != itr_end )
    {
-      modify( *itr, [this,allow_negative_votes]( worker_object& obj )
+      const uint64_t votes_for = _vote_tally_buffer[itr->vote_for];
+      const uint64_t votes_against = allow_negative_votes ? _vote_tally_buffer[itr->vote_against] : 0;
+      // only modify workers whose votes changed, to keep the undo state small
+      if( itr->total_votes_for != votes_for || itr->total_votes_against != votes_against )
       {
-         obj.total_votes_for = _vote_tally_buffer[obj.vote_for];
-         obj.total_votes_against = allow_negative_votes ? _vote_tally_buffer[obj.vote_against] : 0;
-      });
+         modify( *itr, [votes_for,votes_against]( worker_object& obj )
+         {
+            obj.total_votes_for = votes_for;
+            obj.total_votes_against = votes_against;
+         });
+      }
       ++itr;
    }
 }
 
-void database::pay_workers( share_type& budget )
+void database::compute_worker_pay( fc::time_point_sec now, share_type& budget,
+                                   vector< std::pair< worker_id_type, share_type > >& worker_pay )const
 {
-   const auto head_time = head_block_time();
 //   ilog("Processing payroll! Available budget is ${b}", ("b", budget));
    vector<std::reference_wrapper<const worker_object>> active_workers;
    // TODO optimization: add by_expiration index to avoid iterating through all objects
-   get_index_type<worker_index>().inspect_all_objects([head_time, &active_workers](const object& o) {
+   get_index_type<worker_index>().inspect_all_objects([now, &active_workers](const object& o) {
       const worker_object& w = static_cast<const worker_object&>(o);
-      if( w.is_active(head_time) && w.approving_stake() > 0 )
+      if( w.is_active(now) && w.approving_stake() > 0 )
          active_workers.emplace_back(w);
    });
 
@@ -171,7 +205,7 @@ void database::pay_workers( share_type& budget )
    });
 
    const auto last_budget_time = get_dynamic_global_properties().last_budget_time;
-   const auto passed_time_ms = head_time - last_budget_time;
+   const auto passed_time_ms = now - last_budget_time;
    const auto passed_time_count = passed_time_ms.count();
    const auto day_count = fc::days(1).count();
    for( uint32_t i = 0; i < active_workers.size() && budget > 0; ++i )
@@ -189,9 +223,7 @@ void database::pay_workers( share_type& budget )
 
       share_type actual_pay = std::min(budget, requested_pay);
       //ilog(" ==> Paying ${a} to worker ${w}", ("w", active_worker.id)("a", actual_pay));
-      modify(active_worker, [&](worker_object& w) {
-         w.worker.visit(worker_pay_visitor(actual_pay, *this));
-      });
+      worker_pay.emplace_back( active_worker.id, actual_pay );
 
       budget -= actual_pay;
    }
@@ -225,9 +257,12 @@ void database::update_active_witnesses()
    const global_property_object& gpo = get_global_properties();
 
    auto update_witness_total_votes = [this]( const witness_object& wit ) {
-      modify( wit, [this]( witness_object& obj )
+      const uint64_t total_votes = _vote_tally_buffer[wit.vote_id];
+      if( wit.total_votes == total_votes )
+         return;
+      modify( wit, [total_votes]( witness_object& obj )
       {
-         obj.total_votes = _vote_tally_buffer[obj.vote_id];
+         obj.total_votes = total_votes;
       });
    };
 
@@ -323,9 +358,12 @@ void database::update_active_committee_members()
    auto committee_members = sort_votable_objects<committee_member_index>( committee_member_count );
 
    auto update_committee_member_total_votes = [this]( const committee_member_object& cm ) {
-      modify( cm, [this]( committee_member_object& obj )
+      const uint64_t total_votes = _vote_tally_buffer[cm.vote_id];
+      if( cm.total_votes == total_votes )
+         return;
+      modify( cm, [total_votes]( committee_member_object& obj )
       {
-         obj.total_votes = _vote_tally_buffer[obj.vote_id];
+         obj.total_votes = total_votes;
       });
    };
 
@@ -447,6 +485,65 @@ void database::initialize_budget_record( fc::time_point_sec now, budget_record&
    return;
 }
 
+void database::compute_budget( fc::time_point_sec now, fc::time_point_sec next_maintenance_time, budget_record& rec,
+                               vector< std::pair< worker_id_type, share_type > >& worker_pay )const
+{
+   const global_property_object& gpo = get_global_properties();
+
+   int64_t time_to_maint = (next_maintenance_time - now).to_seconds();
+   //
+   // The code that generates the next maintenance time should
+   //    only produce a result in the future.  If this assert
+   //    fails, then the next maintenance time algorithm is buggy.
+   //
+   assert( time_to_maint > 0 );
+   //
+   // Code for setting chain parameters should validate
+   //    block_interval > 0 (as well as the humans proposing /
+   //    voting on changes to block interval).
+   //
+   assert( gpo.parameters.block_interval > 0 );
+   uint64_t blocks_to_maint = (uint64_t(time_to_maint) + gpo.parameters.block_interval - 1) / gpo.parameters.block_interval;
+
+   // blocks_to_maint > 0 because time_to_maint > 0,
+   // which means numerator is at least equal to block_interval
+
+   initialize_budget_record( now, rec );
+   share_type available_funds = rec.total_budget;
+
+   share_type witness_budget = gpo.parameters.witness_pay_per_block.value * blocks_to_maint;
+   rec.requested_witness_budget = witness_budget;
+   witness_budget = std::min(witness_budget, available_funds);
+   rec.witness_budget = witness_budget;
+   available_funds -= witness_budget;
+
+   fc::uint128_t worker_budget_u128 = gpo.parameters.worker_budget_per_day.value;
+   worker_budget_u128 *= uint64_t(time_to_maint);
+   worker_budget_u128 /= 60*60*24;
+
+   share_type worker_budget;
+   if( worker_budget_u128 >= available_funds.value )
+      worker_budget = available_funds;
+   else
+      worker_budget = static_cast<uint64_t>(worker_budget_u128);
+   rec.worker_budget = worker_budget;
+   available_funds -= worker_budget;
+
+   share_type leftover_worker_funds = worker_budget;
+   compute_worker_pay( now, leftover_worker_funds, worker_pay );
+   rec.leftover_worker_funds = leftover_worker_funds;
+   available_funds += leftover_worker_funds;
+
+   rec.supply_delta = rec.witness_budget
+      + rec.worker_budget
+      - rec.leftover_worker_funds
+      - rec.from_accumulated_fees
+      - rec.from_unused_witness_budget;
+
+   // available_funds is money we could spend, but don't want to.
+   // we simply let it evaporate back into the reserve.
+}
+
 /**
  * Update the budget for witnesses and workers.
  */
@@ -454,70 +551,29 @@ void database::process_budget()
 {
    try
    {
-      const global_property_object& gpo = get_global_properties();
       const dynamic_global_property_object& dpo = get_dynamic_global_properties();
       const asset_dynamic_data_object& core = get_core_dynamic_data();
       fc::time_point_sec now = head_block_time();
 
-      int64_t time_to_maint = (dpo.next_maintenance_time - now).to_seconds();
-      //
-      // The code that generates the next maintenance time should
-      //    only produce a result in the future.  If this assert
-      //    fails, then the next maintenance time algorithm is buggy.
-      //
-      assert( time_to_maint > 0 );
-      //
-      // Code for setting chain parameters should validate
-      //    block_interval > 0 (as well as the humans proposing /
-      //    voting on changes to block interval).
-      //
-      assert( gpo.parameters.block_interval > 0 );
-      uint64_t blocks_to_maint = (uint64_t(time_to_maint) + gpo.parameters.block_interval - 1) / gpo.parameters.block_interval;
-
-      // blocks_to_maint > 0 because time_to_maint > 0,
-      // which means numerator is at least equal to block_interval
-
       budget_record rec;
-      initialize_budget_record( now, rec );
-      share_type available_funds = rec.total_budget;
-
-      share_type witness_budget = gpo.parameters.witness_pay_per_block.value * blocks_to_maint;
-      rec.requested_witness_budget = witness_budget;
-      witness_budget = std::min(witness_budget, available_funds);
-      rec.witness_budget = witness_budget;
-      available_funds -= witness_budget;
-
-      fc::uint128_t worker_budget_u128 = gpo.parameters.worker_budget_per_day.value;
-      worker_budget_u128 *= uint64_t(time_to_maint);
-      worker_budget_u128 /= 60*60*24;
-
-      share_type worker_budget;
-      if( worker_budget_u128 >= available_funds.value )
-         worker_budget = available_funds;
-      else
-         worker_budget = static_cast<uint64_t>(worker_budget_u128);
-      rec.worker_budget = worker_budget;
-      available_funds -= worker_budget;
-
-      share_type leftover_worker_funds = worker_budget;
-      pay_workers(leftover_worker_funds);
-      rec.leftover_worker_funds = leftover_worker_funds;
-      available_funds += leftover_worker_funds;
+      vector< std::pair< worker_id_type, share_type > > worker_pay;
+      compute_budget( now, dpo.next_maintenance_time, rec, worker_pay );
 
-      rec.supply_delta = rec.witness_budget
-         + rec.worker_budget
-         - rec.leftover_worker_funds
-         - rec.from_accumulated_fees
-         - rec.from_unused_witness_budget;
+      for( const auto& pay : worker_pay )
+      {
+         modify( pay.first(*this), [this,&pay]( worker_object& w ) {
+            w.worker.visit( worker_pay_visitor( pay.second, *this ) );
+         });
+      }
 
       modify(core, [&]( asset_dynamic_data_object& _core )
       {
          _core.current_supply = (_core.current_supply + rec.supply_delta );
 
          assert( rec.supply_delta ==
-                                   witness_budget
-                                 + worker_budget
-                                 - leftover_worker_funds
+                                   rec.witness_budget
+                                 + rec.worker_budget
+                                 - rec.leftover_worker_funds
                                  - _core.accumulated_fees
                                  - dpo.witness_budget
                                 );
@@ -529,7 +585,7 @@ void database::process_budget()
          // Since initial witness_budget was rolled into
          // available_funds, we replace it with witness_budget
          // instead of adding it.
-         _dpo.witness_budget = witness_budget;
+         _dpo.witness_budget = rec.witness_budget;
          _dpo.last_budget_time = now;
       });
 
@@ -538,13 +594,23 @@ void database::process_budget()
          _rec.time = head_block_time();
          _rec.record = rec;
       });
-
-      // available_funds is money we could spend, but don't want to.
-      // we simply let it evaporate back into the reserve.
    }
    FC_CAPTURE_AND_RETHROW()
 }
 
+budget_simulation database::simulate_budget()const
+{ try {
+   const fc::time_point_sec maintenance_time = get_dynamic_global_properties().next_maintenance_time;
+
+   budget_simulation result;
+   result.time = maintenance_time;
+   // the maintenance block is assumed to arrive on time, the budget is processed after the next maintenance
+   // time is set
+   compute_budget( maintenance_time, maintenance_time + get_global_properties().parameters.maintenance_interval,
+                   result.record, result.worker_pay );
+   return result;
+} FC_CAPTURE_AND_RETHROW() }
+
 template< typename Visitor >
 void visit_special_authorities( const database& db, Visitor visit )
 {
@@ -566,6 +632,7 @@ void visit_special_authorities( const database& db, Visitor visit )
 
 void update_top_n_authorities( database& db )
 {
+   const auto& bal_idx = db.get_index_type< account_balance_index >().indices().get< by_asset_balance >();
    visit_special_authorities( db,
    [&]( const account_object& acct, bool is_owner, const special_authority& auth )
    {
@@ -575,16 +642,15 @@ void update_top_n_authorities( database& db )
 
          const top_holders_special_authority& tha = auth.get< top_holders_special_authority >();
          vote_counter vc;
-         const auto& bal_idx = db.get_index_type< account_balance_index >().indices().get< by_asset_balance >();
          uint8_t num_needed = tha.num_top_holders;
          if( num_needed == 0 )
             return;
 
-         // find accounts
-         const auto range = bal_idx.equal_range( boost::make_tuple( tha.asset ) );
-         for( const account_balance_object& bal : boost::make_iterator_range( range.first, range.second ) )
+         // find accounts, the balances of an asset are ordered by amount, so only the top holders are visited
+         for( auto itr = bal_idx.lower_bound( boost::make_tuple( tha.asset ) );
+              itr != bal_idx.end() && itr->asset_type == tha.asset; ++itr )
          {
-             assert( bal.asset_type == tha.asset );
+             const account_balance_object& bal = *itr;
              if( bal.owner == acct.id )
                 continue;
              vc.add( bal.owner, bal.balance.value );
@@ -593,11 +659,21 @@ void update_top_n_authorities( database& db )
                 break;
          }
 
+         // without holders the authority is left as it is
+         if( vc.is_empty() )
+            return;
+
+         // most of the time the top holders did not change, don't modify the account then
+         const uint8_t flag = ( is_owner ? account_object::top_n_control_owner : account_object::top_n_control_active );
+         authority new_auth;
+         vc.finish( new_auth );
+         if( ( acct.top_n_control_flags & flag ) && new_auth == ( is_owner ? acct.owner : acct.active ) )
+            return;
+
          db.modify( acct, [&]( account_object& a )
          {
-            vc.finish( is_owner ? a.owner : a.active );
-            if( !vc.is_empty() )
-               a.top_n_control_flags |= (is_owner ? account_object::top_n_control_owner : account_object::top_n_control_active);
+            ( is_owner ? a.owner : a.active ) = std::move( new_auth );
+            a.top_n_control_flags |= flag;
          } );
       }
    } );
@@ -689,7 +765,17 @@ void distribute_fba_balances( database& db )
    split_fba_balance( db, fba_accumulator_id_transfer_from_blind, 20*GRAPHENE_1_PERCENT, 60*GRAPHENE_1_PERCENT, 20*GRAPHENE_1_PERCENT );
 }
 
-void create_buyback_orders( database& db )
+/// A buyback order to be placed in chain maintenance, selling all holdings of an asset at any price
+struct buyback_order
+{
+   account_id_type buyback_account;
+   asset           amount_to_sell;
+   asset_id_type   asset_to_buy;
+};
+
+/// Calls f for the buyback orders to place, in the order of buyback objects and of the assets to sell
+template<typename Function>
+void for_each_buyback_order( const database& db, Function f )
 {
    const auto& bbo_idx = db.get_index_type< buyback_index >().indices().get<by_id>();
    const auto& bal_idx = db.get_index_type< primary_index< account_balance_index > >().get_secondary_index< balances_by_account_index >();
@@ -722,41 +808,82 @@ void create_buyback_orders( database& db )
             continue;
          }
 
-         try
-         {
-            transaction_evaluation_state buyback_context(&db);
-            buyback_context.skip_fee_schedule_check = true;
+         f( buyback_order{ buyback_account.id, asset( amount_to_sell, asset_to_sell ), asset_to_buy.id } );
+      }
+   }
+}
 
-            limit_order_create_operation create_vop;
-            create_vop.fee = asset( 0, asset_id_type() );
-            create_vop.seller = buyback_account.id;
-            create_vop.amount_to_sell = asset( amount_to_sell, asset_to_sell );
-            create_vop.min_to_receive = asset( 1, asset_to_buy.id );
-            create_vop.expiration = time_point_sec::maximum();
-            create_vop.fill_or_kill = false;
+/// Creates the order, lets it match and cancels what is left of it
+void place_buyback_order( database& db, const buyback_order& order )
+{
+   try
+   {
+      transaction_evaluation_state buyback_context(&db);
+      buyback_context.skip_fee_schedule_check = true;
 
-            limit_order_id_type order_id = db.apply_operation( buyback_context, create_vop ).get< object_id_type >();
+      limit_order_create_operation create_vop;
+      create_vop.fee = asset( 0, asset_id_type() );
+      create_vop.seller = order.buyback_account;
+      create_vop.amount_to_sell = order.amount_to_sell;
+      create_vop.min_to_receive = asset( 1, order.asset_to_buy );
+      create_vop.expiration = time_point_sec::maximum();
+      create_vop.fill_or_kill = false;
 
-            if( db.find( order_id ) != nullptr )
-            {
-               limit_order_cancel_operation cancel_vop;
-               cancel_vop.fee = asset( 0, asset_id_type() );
-               cancel_vop.order = order_id;
-               cancel_vop.fee_paying_account = buyback_account.id;
+      limit_order_id_type order_id = db.apply_operation( buyback_context, create_vop ).get< object_id_type >();
 
-               db.apply_operation( buyback_context, cancel_vop );
-            }
-         }
-         catch( const fc::exception& e )
-         {
-            // we can in fact get here, e.g. if asset issuer of buy/sell asset blacklists/whitelists the buyback account
-            wlog( "Skipping buyback processing selling ${as} for ${ab} for buyback account ${b} at block ${n}; exception was ${e}",
-                  ("as", asset_to_sell)("ab", asset_to_buy)("b", buyback_account)("n", db.head_block_num())("e", e.to_detail_string()) );
-            continue;
-         }
+      if( db.find( order_id ) != nullptr )
+      {
+         limit_order_cancel_operation cancel_vop;
+         cancel_vop.fee = asset( 0, asset_id_type() );
+         cancel_vop.order = order_id;
+         cancel_vop.fee_paying_account = order.buyback_account;
+
+         db.apply_operation( buyback_context, cancel_vop );
       }
    }
-   return;
+   catch( const fc::exception& e )
+   {
+      // we can in fact get here, e.g. if asset issuer of buy/sell asset blacklists/whitelists the buyback account
+      wlog( "Skipping buyback processing selling ${as} for ${ab} for buyback account ${b} at block ${n}; exception was ${e}",
+            ("as", order.amount_to_sell.asset_id)("ab", order.asset_to_buy)("b", order.buyback_account)
+            ("n", db.head_block_num())("e", e.to_detail_string()) );
+   }
+}
+
+/**
+ * Whether a buyback order could be filled at all. If not, creating the order would have no effect other than
+ * using up an object ID, since it is cancelled right away.
+ */
+bool buyback_order_may_fill( const database& db, const buyback_order& order )
+{
+   const asset_id_type sell_asset_id = order.amount_to_sell.asset_id;
+
+   // limit orders selling the asset to buy at a price the buyback order accepts
+   const auto& order_books = db.get_index_type< primary_index< limit_order_index > >()
+                                .get_secondary_index< limit_order_book_index >();
+   const auto& opposite_side = order_books.get_orders( order.asset_to_buy, sell_asset_id );
+   const price max_price = asset( 1, order.asset_to_buy ) / order.amount_to_sell;
+   if( opposite_side.upper_bound( price_key( max_price ) ) != opposite_side.begin() )
+      return true;
+
+   // margin calls, if the buyback account sells a market-issued asset for its backing asset
+   const asset_object& sell_asset = sell_asset_id(db);
+   if( !sell_asset.is_market_issued()
+         || sell_asset.bitasset_data(db).options.short_backing_asset != order.asset_to_buy )
+      return false;
+   const auto& call_collateral_idx = db.get_index_type<call_order_index>().indices().get<by_collateral>();
+   auto call_itr = call_collateral_idx.lower_bound( price::min( order.asset_to_buy, sell_asset_id ) );
+   return call_itr != call_collateral_idx.end() && call_itr->debt_type() == sell_asset_id;
+}
+
+void create_buyback_orders( database& db )
+{
+   // after the hardfork, orders that can not be filled are no longer created and cancelled right away
+   const bool skip_unfillable = db.get_hardfork_state().passed( maintenance_hardfork::CORE_UNFILLABLE_BUYBACK );
+   for_each_buyback_order( db, [&db,skip_unfillable]( const buyback_order& order ) {
+      if( !skip_unfillable || buyback_order_may_fill( db, order ) )
+         place_buyback_order( db, order );
+   });
 }
 
 void deprecate_annual_members( database& db )
@@ -1143,12 +1270,45 @@ void process_hf_935( database& db )
    }
 }
 
+void database::process_deferred_fees()
+{ try {
+   const auto& dgpo = get_dynamic_global_properties();
+   if( !dgpo.next_fee_processing_account.valid() )
+      return;
+
+   // Accounts are paid out in the order of their names. Accounts that pay fees before the one currently being
+   // processed are paid out after the next maintenance.
+   const auto& stats_idx = get_index_type< account_stats_index >().indices().get< by_pending_fees >();
+   string next_account = *dgpo.next_fee_processing_account;
+   auto itr = stats_idx.lower_bound( boost::make_tuple( true, next_account ) );
+   for( uint32_t processed = 0;
+        processed < GRAPHENE_MAX_FEE_PROCESSING_ACCOUNTS_PER_BLOCK && itr != stats_idx.end();
+        ++processed )
+   {
+      const account_statistics_object& stats = *itr;
+      next_account = stats.name;
+      stats.process_fees( stats.owner( *this ), *this );
+      // processing moved the account out of the range of accounts with pending fees
+      itr = stats_idx.lower_bound( boost::make_tuple( true, next_account ) );
+   }
+
+   modify( dgpo, [&stats_idx,&itr]( dynamic_global_property_object& d ) {
+      if( itr == stats_idx.end() )
+         d.next_fee_processing_account.reset();
+      else
+         d.next_fee_processing_account = itr->name;
+   });
+} FC_CAPTURE_AND_RETHROW() }
+
 void database::perform_chain_maintenance(const signed_block& next_block, const global_property_object& global_props)
 {
    const auto& gpo = get_global_properties();
 
-   distribute_fba_balances(*this);
-   create_buyback_orders(*this);
+   auto& profiler = _maintenance_profiler;
+   profiler.begin( next_block.block_num(), next_block.timestamp );
+
+   profiler.run_phase( "distribute_fba_balances", [this]() { distribute_fba_balances(*this); } );
+   profiler.run_phase( "create_buyback_orders", [this]() { create_buyback_orders(*this); } );
 
    struct vote_tally_helper {
       database& d;
@@ -1215,7 +1375,11 @@ void database::perform_chain_maintenance(const signed_block& next_block, const g
       }
    } tally_helper(*this, gpo);
 
-   perform_account_maintenance( tally_helper );
+   // after the hardfork, pending fees are paid out in the following blocks instead, see process_deferred_fees()
+   const bool defer_fees = get_hardfork_state().passed( maintenance_hardfork::CORE_DEFERRED_FEES );
+   profiler.run_phase( "perform_account_maintenance", [this,&tally_helper,defer_fees]() {
+      perform_account_maintenance( tally_helper, !defer_fees );
+   });
 
    struct clear_canary {
       clear_canary(vector<uint64_t>& target): target(target){}
@@ -1227,10 +1391,10 @@ void database::perform_chain_maintenance(const signed_block& next_block, const g
                 b(_committee_count_histogram_buffer),
                 c(_vote_tally_buffer);
 
-   update_top_n_authorities(*this);
-   update_active_witnesses();
-   update_active_committee_members();
-   update_worker_votes();
+   profiler.run_phase( "update_top_n_authorities", [this]() { update_top_n_authorities(*this); } );
+   profiler.run_phase( "update_active_witnesses", [this]() { update_active_witnesses(); } );
+   profiler.run_phase( "update_active_committee_members", [this]() { update_active_committee_members(); } );
+   profiler.run_phase( "update_worker_votes", [this]() { update_worker_votes(); } );
 
    const auto& dgpo = get_dynamic_global_properties();
    
@@ -1277,7 +1441,7 @@ void database::perform_chain_maintenance(const signed_block& next_block, const g
    }
 
    if( (dgpo.next_maintenance_time < HARDFORK_613_TIME) && (next_maintenance_time >= HARDFORK_613_TIME) )
-      deprecate_annual_members(*this);
+      profiler.run_phase( "deprecate_annual_members", [this]() { deprecate_annual_members(*this); } );
 
    // To reset call_price of all call orders, then match by new rule, for hard fork core-343
    bool to_update_and_match_call_orders_for_hf_343 = false;
@@ -1286,12 +1450,14 @@ void database::perform_chain_maintenance(const signed_block& next_block, const g
 
    // Process inconsistent price feeds
    if( (dgpo.next_maintenance_time <= HARDFORK_CORE_868_890_TIME) && (next_maintenance_time > HARDFORK_CORE_868_890_TIME) )
-      process_hf_868_890( *this, to_update_and_match_call_orders_for_hf_343 );
+      profiler.run_phase( "process_hf_868_890", [this,to_update_and_match_call_orders_for_hf_343]() {
+         process_hf_868_890( *this, to_update_and_match_call_orders_for_hf_343 );
+      });
 
    // Explicitly call check_call_orders of all markets
    if( (dgpo.next_maintenance_time <= HARDFORK_CORE_935_TIME) && (next_maintenance_time > HARDFORK_CORE_935_TIME)
          && !to_update_and_match_call_orders_for_hf_343 )
-      process_hf_935( *this );
+      profiler.run_phase( "process_hf_935", [this]() { process_hf_935( *this ); } );
 
    // To reset call_price of all call orders, then match by new rule, for hard fork core-1270
    bool to_update_and_match_call_orders_for_hf_1270 = false;
@@ -1300,33 +1466,50 @@ void database::perform_chain_maintenance(const signed_block& next_block, const g
 
    // make sure current_supply is less than or equal to max_supply
    if ( dgpo.next_maintenance_time <= HARDFORK_CORE_1465_TIME && next_maintenance_time > HARDFORK_CORE_1465_TIME )
-      process_hf_1465(*this);
+      profiler.run_phase( "process_hf_1465", [this]() { process_hf_1465(*this); } );
 
-   modify(dgpo, [next_maintenance_time](dynamic_global_property_object& d) {
+   modify(dgpo, [next_maintenance_time,defer_fees](dynamic_global_property_object& d) {
       d.next_maintenance_time = next_maintenance_time;
       d.accounts_registered_this_interval = 0;
+      // accounts that were not reached since the last maintenance are paid out in this round
+      if( defer_fees )
+         d.next_fee_processing_account = string();
    });
 
    // We need to do it after updated next_maintenance_time, to apply new rules here, for hard fork core-343
    if( to_update_and_match_call_orders_for_hf_343 )
    {
-      update_call_orders_hf_343(*this);
-      match_call_orders(*this);
+      profiler.run_phase( "update_call_orders_hf_343", [this]() {
+         update_call_orders_hf_343(*this);
+         match_call_orders(*this);
+      });
    }
 
    // We need to do it after updated next_maintenance_time, to apply new rules here, for hard fork core-1270.
    if( to_update_and_match_call_orders_for_hf_1270 )
    {
-      update_call_orders_hf_1270(*this);
-      update_median_feeds(*this);
-      match_call_orders(*this);
+      profiler.run_phase( "update_call_orders_hf_1270", [this]() {
+         update_call_orders_hf_1270(*this);
+         update_median_feeds(*this);
+         match_call_orders(*this);
+      });
    }
 
-   process_bitassets();
+   profiler.run_phase( "process_bitassets", [this]() { process_bitassets(); } );
 
    // process_budget needs to run at the bottom because
    //   it needs to know the next_maintenance_time
-   process_budget();
+   profiler.run_phase( "process_budget", [this]() { process_budget(); } );
+
+   const execution_profile* profile = profiler.end();
+   if( profile != nullptr )
+   {
+      ilog( "Chain maintenance at block ${b} took ${t}us with ${c} object changes",
+            ("b",profile->block_num)("t",profile->microseconds)("c",profile->object_changes) );
+      for( const phase_profile& phase : profile->phases )
+         ilog( "   ${name}: ${t}us, ${c} object changes",
+               ("name",phase.name)("t",phase.microseconds)("c",phase.object_changes) );
+   }
 }
 
 } }
@@ -219,6 +219,7 @@ void database::open(
                     ("last_block->id", last_block)("head_block_id",head_block_num()) );
          reindex( data_dir );
       }
+      refresh_witness_schedule_cache();
       _opened = true;
    }
    FC_CAPTURE_LOG_AND_RETHROW( (data_dir) )
@@ -30,6 +30,8 @@
 #include <graphene/chain/market_object.hpp>
 #include <graphene/chain/is_authorized_asset.hpp>
 
+#include <graphene/protocol/fixed_point.hpp>
+
 #include <fc/uint128.hpp>
 
 namespace graphene { namespace chain {
@@ -38,11 +40,9 @@ namespace detail {
 
    share_type calculate_percent(const share_type& value, uint16_t percent)
    {
-      fc::uint128_t a(value.value);
-      a *= percent;
-      a /= GRAPHENE_100_PERCENT;
-      FC_ASSERT( a <= GRAPHENE_MAX_SHARE_SUPPLY, "overflow when calculating percent" );
-      return static_cast<int64_t>(a);
+      int64_t result;
+      FC_ASSERT( fixed_point::percent_of( value.value, percent, result ), "overflow when calculating percent" );
+      return result;
    }
 
 } //detail
@@ -67,12 +67,14 @@ void database::globally_settle_asset( const asset_object& mia, const price& sett
 
    const auto& call_price_index = get_index_type<call_order_index>().indices().get<by_price>();
 
-   auto maint_time = get_dynamic_global_properties().next_maintenance_time;
-   bool before_core_hardfork_342 = ( maint_time <= HARDFORK_CORE_342_TIME ); // better rounding
+   const hardfork_state& hardforks = get_hardfork_state();
+   bool before_core_hardfork_342 = hardforks.before( maintenance_hardfork::CORE_342 ); // better rounding
 
    // cancel all call orders and accumulate it into collateral_gathered
-   auto call_itr = call_price_index.lower_bound( price::min( bitasset.options.short_backing_asset, mia.id ) );
-   auto call_end = call_price_index.upper_bound( price::max( bitasset.options.short_backing_asset, mia.id ) );
+   const price_key call_min( price::min( bitasset.options.short_backing_asset, mia.id ) );
+   const price_key call_max( price::max( bitasset.options.short_backing_asset, mia.id ) );
+   auto call_itr = call_price_index.lower_bound( call_min );
+   auto call_end = call_price_index.upper_bound( call_max );
    asset pays;
    while( call_itr != call_end )
    {
@@ -183,7 +185,7 @@ void database::execute_bid( const collateral_bid_object& bid, share_type debt_co
          call.collateral = bid.inv_swan_price.base.amount + collateral_from_fund;
          call.debt = debt_covered;
          // don't calculate call_price after core-1270 hard fork
-         if( get_dynamic_global_properties().next_maintenance_time > HARDFORK_CORE_1270_TIME )
+         if( get_hardfork_state().passed( maintenance_hardfork::CORE_1270 ) )
             // bid.inv_swan_price is in collateral / debt
             call.call_price = price( asset( 1, bid.inv_swan_price.base.asset_id ),
                                      asset( 1, bid.inv_swan_price.quote.asset_id ) );
@@ -221,13 +223,34 @@ void database::cancel_settle_order(const force_settlement_object& order, bool cr
 }
 
 void database::cancel_limit_order( const limit_order_object& order, bool create_virtual_op, bool skip_cancel_fee )
+{
+   limit_order_refunds refunds;
+   collect_limit_order_refunds( order, create_virtual_op, skip_cancel_fee, refunds );
+   apply_limit_order_refunds( refunds );
+}
+
+void database::limit_order_refunds::add_balance( account_id_type account, const asset& delta )
+{
+   if( delta.amount == 0 )
+      return;
+   auto key = std::make_pair( account, delta.asset_id );
+   auto itr = balance_positions.find( key );
+   if( itr == balance_positions.end() )
+   {
+      balance_positions[ key ] = balances.size();
+      balances.emplace_back( key, delta.amount );
+   }
+   else
+      balances[ itr->second ].second += delta.amount;
+}
+
+void database::collect_limit_order_refunds( const limit_order_object& order, bool create_virtual_op,
+                                            bool skip_cancel_fee, limit_order_refunds& refunds )
 {
    // if need to create a virtual op, try deduct a cancellation fee here.
    // there are two scenarios when order is cancelled and need to create a virtual op:
    // 1. due to expiration: always deduct a fee if there is any fee deferred
    // 2. due to cull_small: deduct a fee after hard fork 604, but not before (will set skip_cancel_fee)
-   const account_statistics_object* seller_acc_stats = nullptr;
-   const asset_dynamic_data_object* fee_asset_dyn_data = nullptr;
    limit_order_cancel_operation vop;
    share_type deferred_fee = order.deferred_fee;
    asset deferred_paid_fee = order.deferred_paid_fee;
@@ -245,10 +268,12 @@ void database::cancel_limit_order( const limit_order_object& order, bool create_
          // if there is any CORE fee to deduct, redirect it to referral program
          if( core_cancel_fee.amount > 0 )
          {
-            seller_acc_stats = &order.seller( *this ).statistics( *this );
-            modify( *seller_acc_stats, [&]( account_statistics_object& obj ) {
-               obj.pay_fee( core_cancel_fee.amount, get_global_properties().parameters.cashback_vesting_threshold );
-            } );
+            // same as account_statistics_object::pay_fee()
+            auto& stats = refunds.statistics[ order.seller ];
+            if( core_cancel_fee.amount > get_global_properties().parameters.cashback_vesting_threshold )
+               stats.pending_fees += core_cancel_fee.amount;
+            else
+               stats.pending_vested_fees += core_cancel_fee.amount;
             deferred_fee -= core_cancel_fee.amount;
             // handle originally paid fee if any:
             //    to_deduct = round_up( paid_fee * core_cancel_fee / deferred_core_fee_before_deduct )
@@ -266,10 +291,7 @@ void database::cancel_limit_order( const limit_order_object& order, bool create_
                fee128 /= order.deferred_fee.value;
                share_type cancel_fee_amount = static_cast<int64_t>(fee128);
                // cancel_fee should be positive, pay it to asset's accumulated_fees
-               fee_asset_dyn_data = &deferred_paid_fee.asset_id(*this).dynamic_asset_data_id(*this);
-               modify( *fee_asset_dyn_data, [&](asset_dynamic_data_object& addo) {
-                  addo.accumulated_fees += cancel_fee_amount;
-               });
+               refunds.fees[ deferred_paid_fee.asset_id ].accumulated_fees += cancel_fee_amount;
                // cancel_fee should be no more than deferred_paid_fee
                deferred_paid_fee.amount -= cancel_fee_amount;
                vop.fee = asset( cancel_fee_amount, deferred_paid_fee.asset_id );
@@ -281,14 +303,8 @@ void database::cancel_limit_order( const limit_order_object& order, bool create_
    // refund funds in order
    auto refunded = order.amount_for_sale();
    if( refunded.asset_id == asset_id_type() )
-   {
-      if( seller_acc_stats == nullptr )
-         seller_acc_stats = &order.seller( *this ).statistics( *this );
-      modify( *seller_acc_stats, [&]( account_statistics_object& obj ) {
-         obj.total_core_in_orders -= refunded.amount;
-      });
-   }
-   adjust_balance(order.seller, refunded);
+      refunds.statistics[ order.seller ].core_in_orders -= refunded.amount;
+   refunds.add_balance( order.seller, refunded );
 
    // refund fee
    // could be virtual op or real op here
@@ -297,17 +313,13 @@ void database::cancel_limit_order( const limit_order_object& order, bool create_
       // be here, order.create_time <= HARDFORK_CORE_604_TIME, or fee paid in CORE, or no fee to refund.
       // if order was created before hard fork 604 then cancelled no matter before or after hard fork 604,
       //    see it as fee paid in CORE, deferred_fee should be refunded to order owner but not fee pool
-      adjust_balance( order.seller, deferred_fee );
+      refunds.add_balance( order.seller, asset( deferred_fee ) );
    }
    else // need to refund fee in originally paid asset
    {
-      adjust_balance(order.seller, deferred_paid_fee);
+      refunds.add_balance( order.seller, deferred_paid_fee );
       // be here, must have: fee_asset != CORE
-      if( fee_asset_dyn_data == nullptr )
-         fee_asset_dyn_data = &deferred_paid_fee.asset_id(*this).dynamic_asset_data_id(*this);
-      modify( *fee_asset_dyn_data, [&](asset_dynamic_data_object& addo) {
-         addo.fee_pool += deferred_fee;
-      });
+      refunds.fees[ deferred_paid_fee.asset_id ].fee_pool += deferred_fee;
    }
 
    if( create_virtual_op )
@@ -316,6 +328,27 @@ void database::cancel_limit_order( const limit_order_object& order, bool create_
    remove(order);
 }
 
+void database::apply_limit_order_refunds( const limit_order_refunds& refunds )
+{
+   for( const auto& item : refunds.statistics )
+   {
+      modify( item.first( *this ).statistics( *this ), [&item]( account_statistics_object& obj ) {
+         obj.pending_fees += item.second.pending_fees;
+         obj.pending_vested_fees += item.second.pending_vested_fees;
+         obj.total_core_in_orders += item.second.core_in_orders;
+      });
+   }
+   for( const auto& item : refunds.fees )
+   {
+      modify( item.first( *this ).dynamic_asset_data_id( *this ), [&item]( asset_dynamic_data_object& addo ) {
+         addo.accumulated_fees += item.second.accumulated_fees;
+         addo.fee_pool += item.second.fee_pool;
+      });
+   }
+   for( const auto& item : refunds.balances )
+      adjust_balance( item.first.first, asset( item.second, item.first.second ) );
+}
+
 bool maybe_cull_small_order( database& db, const limit_order_object& order )
 {
    /**
@@ -356,7 +389,8 @@ bool database::apply_order_before_hardfork_625(const limit_order_object& new_ord
    if( called_some && !find_object(order_id) ) // then we were filled by call order
       return true;
 
-   const auto& limit_price_idx = get_index_type<limit_order_index>().indices().get<by_price>();
+   const auto& order_books = get_index_type< primary_index< limit_order_index > >()
+                                .get_secondary_index< limit_order_book_index >();
 
    // TODO: it should be possible to simply check the NEXT/PREV iterator after new_order_object to
    // determine whether or not this order has "changed the book" in a way that requires us to
@@ -364,16 +398,17 @@ bool database::apply_order_before_hardfork_625(const limit_order_object& new_ord
    // constant time check. Potential optimization.
 
    auto max_price = ~new_order_object.sell_price;
-   auto limit_itr = limit_price_idx.lower_bound(max_price.max());
-   auto limit_end = limit_price_idx.upper_bound(max_price);
+   const auto& opposite_side = order_books.get_orders( max_price.base.asset_id, max_price.quote.asset_id );
+   auto limit_itr = opposite_side.begin();
+   auto limit_end = opposite_side.upper_bound( price_key( max_price ) );
 
    bool finished = false;
    while( !finished && limit_itr != limit_end )
    {
-      auto old_limit_itr = limit_itr;
+      const limit_order_object& old_limit_order = *limit_itr->second;
       ++limit_itr;
       // match returns 2 when only the old order was fully filled. In this case, we keep matching; otherwise, we stop.
-      finished = (match(new_order_object, *old_limit_itr, old_limit_itr->sell_price) != 2);
+      finished = (match(new_order_object, old_limit_order, old_limit_order.sell_price) != 2);
    }
 
    //Possible optimization: only check calls if the new order completely filled some old order
@@ -400,19 +435,17 @@ bool database::apply_order(const limit_order_object& new_order_object, bool allo
    asset_id_type recv_asset_id = new_order_object.receive_asset_id();
 
    // We only need to check if the new order will match with others if it is at the front of the book
-   const auto& limit_price_idx = get_index_type<limit_order_index>().indices().get<by_price>();
-   auto limit_itr = limit_price_idx.lower_bound( boost::make_tuple( new_order_object.sell_price, order_id ) );
-   if( limit_itr != limit_price_idx.begin() )
-   {
-      --limit_itr;
-      if( limit_itr->sell_asset_id() == sell_asset_id && limit_itr->receive_asset_id() == recv_asset_id )
-         return false;
-   }
+   const auto& order_books = get_index_type< primary_index< limit_order_index > >()
+                                .get_secondary_index< limit_order_book_index >();
+   const auto& own_side = order_books.get_orders( sell_asset_id, recv_asset_id );
+   if( !own_side.empty() && own_side.begin()->second->id != order_id )
+      return false;
 
    // this is the opposite side (on the book)
    auto max_price = ~new_order_object.sell_price;
-   limit_itr = limit_price_idx.lower_bound( max_price.max() );
-   auto limit_end = limit_price_idx.upper_bound( max_price );
+   const auto& opposite_side = order_books.get_orders( recv_asset_id, sell_asset_id );
+   auto limit_itr = opposite_side.begin();
+   auto limit_end = opposite_side.upper_bound( price_key( max_price ) );
 
    // Order matching should be in favor of the taker.
    // When a new limit order is created, e.g. an ask, need to check if it will match the highest bid.
@@ -445,8 +478,8 @@ bool database::apply_order(const limit_order_object& new_order_object, bool allo
    // 5. the call order's collateral ratio is below or equals to MCR
    // 6. the limit order provided a good price
 
-   auto maint_time = get_dynamic_global_properties().next_maintenance_time;
-   bool before_core_hardfork_1270 = ( maint_time <= HARDFORK_CORE_1270_TIME ); // call price caching issue
+   // call price caching issue
+   bool before_core_hardfork_1270 = get_hardfork_state().before( maintenance_hardfork::CORE_1270 );
 
    bool to_check_call_orders = false;
    const asset_object& sell_asset = sell_asset_id( *this );
@@ -473,12 +506,12 @@ bool database::apply_order(const limit_order_object& new_order_object, bool allo
    if( to_check_call_orders )
    {
       // check limit orders first, match the ones with better price in comparison to call orders
-      while( !finished && limit_itr != limit_end && limit_itr->sell_price > call_match_price )
+      while( !finished && limit_itr != limit_end && limit_itr->second->sell_price > call_match_price )
       {
-         auto old_limit_itr = limit_itr;
+         const limit_order_object& old_limit_order = *limit_itr->second;
          ++limit_itr;
          // match returns 2 when only the old order was fully filled. In this case, we keep matching; otherwise, we stop.
-         finished = ( match( new_order_object, *old_limit_itr, old_limit_itr->sell_price ) != 2 );
+         finished = ( match( new_order_object, old_limit_order, old_limit_order.sell_price ) != 2 );
       }
 
       if( !finished && !before_core_hardfork_1270 ) // TODO refactor or cleanup duplicate code after core-1270 hard fork
@@ -515,7 +548,7 @@ bool database::apply_order(const limit_order_object& new_order_object, bool allo
          while( !finished )
          {
             // assume hard fork core-343 and core-625 will take place at same time, always check call order with least call_price
-            auto call_itr = call_price_idx.lower_bound( call_min );
+            auto call_itr = call_price_idx.lower_bound( price_key( call_min ) );
             if( call_itr == call_price_idx.end()
                   || call_itr->debt_type() != sell_asset_id
                   // feed protected https://github.com/cryptonomex/graphene/issues/436
@@ -537,10 +570,10 @@ bool database::apply_order(const limit_order_object& new_order_object, bool allo
    // still need to check limit orders
    while( !finished && limit_itr != limit_end )
    {
-      auto old_limit_itr = limit_itr;
+      const limit_order_object& old_limit_order = *limit_itr->second;
       ++limit_itr;
       // match returns 2 when only the old order was fully filled. In this case, we keep matching; otherwise, we stop.
-      finished = ( match( new_order_object, *old_limit_itr, old_limit_itr->sell_price ) != 2 );
+      finished = ( match( new_order_object, old_limit_order, old_limit_order.sell_price ) != 2 );
    }
 
    const limit_order_object* updated_order_object = find< limit_order_object >( order_id );
@@ -574,8 +607,8 @@ int database::match( const limit_order_object& usd, const limit_order_object& co
 
    asset usd_pays, usd_receives, core_pays, core_receives;
 
-   auto maint_time = get_dynamic_global_properties().next_maintenance_time;
-   bool before_core_hardfork_342 = ( maint_time <= HARDFORK_CORE_342_TIME ); // better rounding
+   const hardfork_state& hardforks = get_hardfork_state();
+   bool before_core_hardfork_342 = hardforks.before( maintenance_hardfork::CORE_342 ); // better rounding
 
    bool cull_taker = false;
    if( usd_for_sale <= core_for_sale * match_price ) // rounding down here should be fine
@@ -584,7 +617,7 @@ int database::match( const limit_order_object& usd, const limit_order_object& co
 
       // Be here, it's possible that taker is paying something for nothing due to partially filled in last loop.
       // In this case, we see it as filled and cancel it later
-      if( usd_receives.amount == 0 && maint_time > HARDFORK_CORE_184_TIME )
+      if( usd_receives.amount == 0 && hardforks.passed( maintenance_hardfork::CORE_184 ) )
          return 1;
 
       if( before_core_hardfork_342 )
@@ -638,11 +671,11 @@ int database::match( const limit_order_object& bid, const call_order_object& ask
    FC_ASSERT( bid.receive_asset_id() == ask.collateral_type() );
    FC_ASSERT( bid.for_sale > 0 && ask.debt > 0 && ask.collateral > 0 );
 
-   auto maint_time = get_dynamic_global_properties().next_maintenance_time;
+   const hardfork_state& hardforks = get_hardfork_state();
    // TODO remove when we're sure it's always false
-   bool before_core_hardfork_184 = ( maint_time <= HARDFORK_CORE_184_TIME ); // something-for-nothing
+   bool before_core_hardfork_184 = hardforks.before( maintenance_hardfork::CORE_184 ); // something-for-nothing
    // TODO remove when we're sure it's always false
-   bool before_core_hardfork_342 = ( maint_time <= HARDFORK_CORE_342_TIME ); // better rounding
+   bool before_core_hardfork_342 = hardforks.before( maintenance_hardfork::CORE_342 ); // better rounding
    // TODO remove when we're sure it's always false
    if( before_core_hardfork_184 )
       ilog( "match(limit,call) is called before hardfork core-184 at block #${block}", ("block",head_block_num()) );
@@ -713,8 +746,8 @@ asset database::match( const call_order_object& call,
    FC_ASSERT(call.get_debt().asset_id == settle.balance.asset_id );
    FC_ASSERT(call.debt > 0 && call.collateral > 0 && settle.balance.amount > 0);
 
-   auto maint_time = get_dynamic_global_properties().next_maintenance_time;
-   bool before_core_hardfork_342 = ( maint_time <= HARDFORK_CORE_342_TIME ); // better rounding
+   const hardfork_state& hardforks = get_hardfork_state();
+   bool before_core_hardfork_342 = hardforks.before( maintenance_hardfork::CORE_342 ); // better rounding
 
    auto settle_for_sale = std::min(settle.balance, max_settlement);
    auto call_debt = call.get_debt();
@@ -727,7 +760,7 @@ asset database::match( const call_order_object& call,
    bool cull_settle_order = false; // whether need to cancel dust settle order
    if( call_pays.amount == 0 )
    {
-      if( maint_time > HARDFORK_CORE_184_TIME )
+      if( hardforks.passed( maintenance_hardfork::CORE_184 ) )
       {
          if( call_receives == call_debt ) // the call order is smaller than or equal to the settle order
          {
@@ -888,10 +921,11 @@ bool database::fill_call_order( const call_order_object& order, const asset& pay
             }
             else
             {
-               auto maint_time = get_dynamic_global_properties().next_maintenance_time;
+               const hardfork_state& hardforks = get_hardfork_state();
                // update call_price after core-343 hard fork,
                // but don't update call_price after core-1270 hard fork
-               if( maint_time <= HARDFORK_CORE_1270_TIME && maint_time > HARDFORK_CORE_343_TIME )
+               if( hardforks.before( maintenance_hardfork::CORE_1270 )
+                     && hardforks.passed( maintenance_hardfork::CORE_343 ) )
                {
                   o.call_price = price::call_price( o.get_debt(), o.get_collateral(),
                                                     mia.bitasset_data(*this).current_feed.maintenance_collateral_ratio );
@@ -973,35 +1007,70 @@ bool database::fill_settle_order( const force_settlement_object& settle, const a
 bool database::check_call_orders( const asset_object& mia, bool enable_black_swan, bool for_new_limit_order,
                                   const asset_bitasset_data_object* bitasset_ptr )
 { try {
-    const auto& dyn_prop = get_dynamic_global_properties();
-    auto maint_time = dyn_prop.next_maintenance_time;
-    if( for_new_limit_order )
-       FC_ASSERT( maint_time <= HARDFORK_CORE_625_TIME ); // `for_new_limit_order` is only true before HF 338 / 625
+    const hardfork_state& hardforks = get_hardfork_state();
+    if( for_new_limit_order ) // `for_new_limit_order` is only true before HF 338 / 625
+       FC_ASSERT( hardforks.before( maintenance_hardfork::CORE_625 ) );
 
     if( !mia.is_market_issued() ) return false;
 
     const asset_bitasset_data_object& bitasset = ( bitasset_ptr ? *bitasset_ptr : mia.bitasset_data(*this) );
 
+    if( hardforks.passed_up_to( maintenance_hardfork::CORE_1270 ) )
+       return check_call_orders<true>( mia, enable_black_swan, for_new_limit_order, bitasset );
+    return check_call_orders<false>( mia, enable_black_swan, for_new_limit_order, bitasset );
+} FC_CAPTURE_AND_RETHROW() }
+
+template< bool AllHardforksPassed >
+bool database::check_call_orders( const asset_object& mia, bool enable_black_swan, bool for_new_limit_order,
+                                  const asset_bitasset_data_object& bitasset )
+{
+    const hardfork_state& hardforks = get_hardfork_state();
+    // call price caching issue
+    bool before_core_hardfork_1270 = hardforks.before<AllHardforksPassed>( maintenance_hardfork::CORE_1270 );
+
+    // limit orders selling USD for CORE
+    const auto& limit_orders = get_index_type< primary_index< limit_order_index > >()
+                                  .get_secondary_index< limit_order_book_index >()
+                                  .get_orders( mia.id, bitasset.options.short_backing_asset );
+
+    // Nothing to do unless the least collateralized position crosses a trigger: either it is below the
+    // maintenance collateralization while the best limit order is above the max short squeeze price,
+    // or it can't cover its debt at the better of both prices. This is the same decision as made by
+    // check_for_blackswan() and the first pass of the loop below, without setting up the iterators.
+    if( !before_core_hardfork_1270 && !bitasset.is_prediction_market && !bitasset.has_settlement()
+          && !bitasset.current_feed.settlement_price.is_null() )
+    {
+       const call_order_object* least_collateralized = get_index_type< primary_index< call_order_index > >()
+                                                          .get_secondary_index< margin_call_trigger_index >()
+                                                          .get_least_collateralized( mia.id );
+       if( least_collateralized == nullptr )
+          return false;
+       price highest = bitasset.current_feed.max_short_squeeze_price();
+       bool limit_order_in_range = ( !limit_orders.empty() && !( limit_orders.begin()->second->sell_price < highest ) );
+       if( limit_order_in_range )
+          highest = limit_orders.begin()->second->sell_price;
+       const price least_collateral = least_collateralized->collateralization();
+       bool margin_call_triggered = ( limit_order_in_range
+                                      && !( bitasset.current_maintenance_collateralization < least_collateral ) );
+       bool black_swan_triggered = ( ~least_collateral >= highest );
+       if( !margin_call_triggered && !black_swan_triggered )
+          return false;
+    }
+
     if( check_for_blackswan( mia, enable_black_swan, &bitasset ) )
        return false;
 
     if( bitasset.is_prediction_market ) return false;
     if( bitasset.current_feed.settlement_price.is_null() ) return false;
 
-    const limit_order_index& limit_index = get_index_type<limit_order_index>();
-    const auto& limit_price_index = limit_index.indices().get<by_price>();
-
-    bool before_core_hardfork_1270 = ( maint_time <= HARDFORK_CORE_1270_TIME ); // call price caching issue
-
-    // looking for limit orders selling the most USD for the least CORE
-    auto max_price = price::max( mia.id, bitasset.options.short_backing_asset );
     // stop when limit orders are selling too little USD for too much CORE
     auto min_price = ( before_core_hardfork_1270 ? bitasset.current_feed.max_short_squeeze_price_before_hf_1270()
                                                  : bitasset.current_feed.max_short_squeeze_price() );
 
-    // NOTE limit_price_index is sorted from greatest to least
-    auto limit_itr = limit_price_index.lower_bound( max_price );
-    auto limit_end = limit_price_index.upper_bound( min_price );
+    // NOTE the book side is sorted from greatest to least, starting with limit orders selling the most USD
+    //      for the least CORE
+    auto limit_itr = limit_orders.begin();
+    auto limit_end = limit_orders.upper_bound( price_key( min_price ) );
 
     if( limit_itr == limit_end )
        return false;
@@ -1020,8 +1089,8 @@ bool database::check_call_orders( const asset_object& mia, bool enable_black_swa
 
     if( before_core_hardfork_1270 )
     {
-       call_price_itr = call_price_index.lower_bound( call_min );
-       call_price_end = call_price_index.upper_bound( call_max );
+       call_price_itr = call_price_index.lower_bound( price_key( call_min ) );
+       call_price_end = call_price_index.upper_bound( price_key( call_max ) );
     }
     else
     {
@@ -1038,12 +1107,18 @@ bool database::check_call_orders( const asset_object& mia, bool enable_black_swa
     bool before_hardfork_615 = ( head_time < HARDFORK_615_TIME );
     bool after_hardfork_436 = ( head_time > HARDFORK_436_TIME );
 
-    bool before_core_hardfork_184 = ( maint_time <= HARDFORK_CORE_184_TIME ); // something-for-nothing
-    bool before_core_hardfork_342 = ( maint_time <= HARDFORK_CORE_342_TIME ); // better rounding
-    bool before_core_hardfork_343 = ( maint_time <= HARDFORK_CORE_343_TIME ); // update call_price after partially filled
-    bool before_core_hardfork_453 = ( maint_time <= HARDFORK_CORE_453_TIME ); // multiple matching issue
-    bool before_core_hardfork_606 = ( maint_time <= HARDFORK_CORE_606_TIME ); // feed always trigger call
-    bool before_core_hardfork_834 = ( maint_time <= HARDFORK_CORE_834_TIME ); // target collateral ratio option
+    // something-for-nothing
+    bool before_core_hardfork_184 = hardforks.before<AllHardforksPassed>( maintenance_hardfork::CORE_184 );
+    // better rounding
+    bool before_core_hardfork_342 = hardforks.before<AllHardforksPassed>( maintenance_hardfork::CORE_342 );
+    // update call_price after partially filled
+    bool before_core_hardfork_343 = hardforks.before<AllHardforksPassed>( maintenance_hardfork::CORE_343 );
+    // multiple matching issue
+    bool before_core_hardfork_453 = hardforks.before<AllHardforksPassed>( maintenance_hardfork::CORE_453 );
+    // feed always trigger call
+    bool before_core_hardfork_606 = hardforks.before<AllHardforksPassed>( maintenance_hardfork::CORE_606 );
+    // target collateral ratio option
+    bool before_core_hardfork_834 = hardforks.before<AllHardforksPassed>( maintenance_hardfork::CORE_834 );
 
     while( !check_for_blackswan( mia, enable_black_swan, &bitasset ) // TODO perhaps improve performance by passing in iterators
            && limit_itr != limit_end
@@ -1060,7 +1135,7 @@ bool database::check_call_orders( const asset_object& mia, bool enable_black_swa
                    && after_hardfork_436 && bitasset.current_feed.settlement_price > ~call_order.call_price ) )
           return margin_called;
 
-       const limit_order_object& limit_order = *limit_itr;
+       const limit_order_object& limit_order = *limit_itr->second;
        price match_price  = limit_order.sell_price;
        // There was a check `match_price.validate();` here, which is removed now because it always passes
 
@@ -1145,7 +1220,7 @@ bool database::check_call_orders( const asset_object& mia, bool enable_black_swa
 
           if( usd_to_buy == usd_for_sale )
              filled_limit = true;
-          else if( filled_limit && maint_time <= HARDFORK_CORE_453_TIME ) // TODO remove warning after hard fork core-453
+          else if( filled_limit && before_core_hardfork_453 ) // TODO remove warning after hard fork core-453
           {
              wlog( "Multiple limit match problem (issue 453) occurred at block #${block}", ("block",head_num) );
              if( before_hardfork_615 )
@@ -1163,7 +1238,7 @@ bool database::check_call_orders( const asset_object& mia, bool enable_black_swa
        if( !before_core_hardfork_1270 )
           call_collateral_itr = call_collateral_index.lower_bound( call_min );
        else if( !before_core_hardfork_343 )
-          call_price_itr = call_price_index.lower_bound( call_min );
+          call_price_itr = call_price_index.lower_bound( price_key( call_min ) );
 
        auto next_limit_itr = std::next( limit_itr );
        // when for_new_limit_order is true, the limit order is taker, otherwise the limit order is maker
@@ -1174,7 +1249,7 @@ bool database::check_call_orders( const asset_object& mia, bool enable_black_swa
     } // while call_itr != call_end
 
     return margin_called;
-} FC_CAPTURE_AND_RETHROW() }
+}
 
 void database::pay_order( const account_object& receiver, const asset& receives, const asset& pays )
 {
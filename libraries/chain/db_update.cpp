@@ -196,52 +196,46 @@ bool database::check_for_blackswan( const asset_object& mia, bool enable_black_s
     asset_id_type debt_asset_id = mia.id;
     auto call_min = price::min( bitasset.options.short_backing_asset, debt_asset_id );
 
-    auto maint_time = get_dynamic_global_properties().next_maintenance_time;
-    bool before_core_hardfork_1270 = ( maint_time <= HARDFORK_CORE_1270_TIME ); // call price caching issue
+    const hardfork_state& hardforks = get_hardfork_state();
+    bool before_core_hardfork_1270 = hardforks.before( maintenance_hardfork::CORE_1270 ); // call price caching issue
 
     if( before_core_hardfork_1270 ) // before core-1270 hard fork, check with call_price
     {
        const auto& call_price_index = get_index_type<call_order_index>().indices().get<by_price>();
-       auto call_itr = call_price_index.lower_bound( call_min );
+       auto call_itr = call_price_index.lower_bound( price_key( call_min ) );
        if( call_itr == call_price_index.end() ) // no call order
           return false;
        call_ptr = &(*call_itr);
     }
     else // after core-1270 hard fork, check with collateralization
     {
-       const auto& call_collateral_index = get_index_type<call_order_index>().indices().get<by_collateral>();
-       auto call_itr = call_collateral_index.lower_bound( call_min );
-       if( call_itr == call_collateral_index.end() ) // no call order
+       call_ptr = get_index_type< primary_index< call_order_index > >()
+                     .get_secondary_index< margin_call_trigger_index >()
+                     .get_least_collateralized( debt_asset_id );
+       if( call_ptr == nullptr ) // no call order
           return false;
-       call_ptr = &(*call_itr);
     }
     if( call_ptr->debt_type() != debt_asset_id ) // no call order
        return false;
 
     price highest = settle_price;
-    if( maint_time > HARDFORK_CORE_1270_TIME )
+    if( !before_core_hardfork_1270 )
        // due to #338, we won't check for black swan on incoming limit order, so need to check with MSSP here
        highest = bitasset.current_feed.max_short_squeeze_price();
-    else if( maint_time > HARDFORK_CORE_338_TIME )
+    else if( hardforks.passed( maintenance_hardfork::CORE_338 ) )
        // due to #338, we won't check for black swan on incoming limit order, so need to check with MSSP here
        highest = bitasset.current_feed.max_short_squeeze_price_before_hf_1270();
 
-    const limit_order_index& limit_index = get_index_type<limit_order_index>();
-    const auto& limit_price_index = limit_index.indices().get<by_price>();
-
     // looking for limit orders selling the most USD for the least CORE
-    auto highest_possible_bid = price::max( mia.id, bitasset.options.short_backing_asset );
-    // stop when limit orders are selling too little USD for too much CORE
-    auto lowest_possible_bid  = price::min( mia.id, bitasset.options.short_backing_asset );
-
-    FC_ASSERT( highest_possible_bid.base.asset_id == lowest_possible_bid.base.asset_id );
-    // NOTE limit_price_index is sorted from greatest to least
-    auto limit_itr = limit_price_index.lower_bound( highest_possible_bid );
-    auto limit_end = limit_price_index.upper_bound( lowest_possible_bid );
-
-    if( limit_itr != limit_end ) {
-       FC_ASSERT( highest.base.asset_id == limit_itr->sell_price.base.asset_id );
-       highest = std::max( limit_itr->sell_price, highest );
+    // NOTE the book side is sorted from greatest to least
+    const auto& limit_orders = get_index_type< primary_index< limit_order_index > >()
+                                  .get_secondary_index< limit_order_book_index >()
+                                  .get_orders( mia.id, bitasset.options.short_backing_asset );
+
+    if( !limit_orders.empty() ) {
+       const price& highest_bid = limit_orders.begin()->second->sell_price;
+       FC_ASSERT( highest.base.asset_id == highest_bid.base.asset_id );
+       highest = std::max( highest_bid, highest );
     }
 
     auto least_collateral = call_ptr->collateralization();
@@ -260,7 +254,7 @@ bool database::check_for_blackswan( const asset_object& mia, bool enable_black_s
             ("h",highest.to_real())("~h",(~highest).to_real()) );
        edump((enable_black_swan));
        FC_ASSERT( enable_black_swan, "Black swan was detected during a margin update which is not allowed to trigger a blackswan" );
-       if( maint_time > HARDFORK_CORE_338_TIME && ~least_collateral <= settle_price )
+       if( hardforks.passed( maintenance_hardfork::CORE_338 ) && ~least_collateral <= settle_price )
           // global settle at feed price if possible
           globally_settle_asset(mia, settle_price );
        else
@@ -274,21 +268,30 @@ void database::clear_expired_orders()
 { try {
          //Cancel expired limit orders
          auto head_time = head_block_time();
-         auto maint_time = get_dynamic_global_properties().next_maintenance_time;
+         const hardfork_state& hardforks = get_hardfork_state();
 
-         bool before_core_hardfork_184 = ( maint_time <= HARDFORK_CORE_184_TIME ); // something-for-nothing
-         bool before_core_hardfork_342 = ( maint_time <= HARDFORK_CORE_342_TIME ); // better rounding
-         bool before_core_hardfork_606 = ( maint_time <= HARDFORK_CORE_606_TIME ); // feed always trigger call
+         bool before_core_hardfork_184 = hardforks.before( maintenance_hardfork::CORE_184 ); // something-for-nothing
+         bool before_core_hardfork_342 = hardforks.before( maintenance_hardfork::CORE_342 ); // better rounding
+         bool before_core_hardfork_606 = hardforks.before( maintenance_hardfork::CORE_606 ); // feed always trigger call
 
          auto& limit_index = get_index_type<limit_order_index>().indices().get<by_expiration>();
-         while( !limit_index.empty() && limit_index.begin()->expiration <= head_time )
+         if( !before_core_hardfork_606 )
+         {
+            // nothing happens between the cancellations, so the refunds of all expired orders are applied
+            // at once, the virtual operations are still pushed one by one in order of expiration
+            limit_order_refunds refunds;
+            while( !limit_index.empty() && limit_index.begin()->expiration <= head_time )
+               collect_limit_order_refunds( *limit_index.begin(), true, false, refunds );
+            apply_limit_order_refunds( refunds );
+         }
+         else
          {
-            const limit_order_object& order = *limit_index.begin();
-            auto base_asset = order.sell_price.base.asset_id;
-            auto quote_asset = order.sell_price.quote.asset_id;
-            cancel_limit_order( order );
-            if( before_core_hardfork_606 )
+            while( !limit_index.empty() && limit_index.begin()->expiration <= head_time )
             {
+               const limit_order_object& order = *limit_index.begin();
+               auto base_asset = order.sell_price.base.asset_id;
+               auto quote_asset = order.sell_price.quote.asset_id;
+               cancel_limit_order( order );
                // check call orders
                // Comments below are copied from limit_order_cancel_evaluator::do_apply(...)
                // Possible optimization: order can be called by cancelling a limit order
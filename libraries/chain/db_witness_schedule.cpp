@@ -35,6 +35,10 @@ using boost::container::flat_set;
 
 witness_id_type database::get_scheduled_witness( uint32_t slot_num )const
 {
+   const witness_schedule_cache* schedule = get_witness_schedule_cache();
+   if( schedule != nullptr )
+      return schedule->get_scheduled_witness( slot_num );
+
    const dynamic_global_property_object& dpo = get_dynamic_global_properties();
    const witness_schedule_object& wso = get_witness_schedule_object();
    uint64_t current_aslot = dpo.current_aslot + slot_num;
@@ -46,6 +50,10 @@ fc::time_point_sec database::get_slot_time(uint32_t slot_num)const
    if( slot_num == 0 )
       return fc::time_point_sec();
 
+   const witness_schedule_cache* schedule = get_witness_schedule_cache();
+   if( schedule != nullptr )
+      return schedule->get_slot_time( slot_num );
+
    auto interval = block_interval();
    const dynamic_global_property_object& dpo = get_dynamic_global_properties();
 
@@ -73,6 +81,10 @@ fc::time_point_sec database::get_slot_time(uint32_t slot_num)const
 
 uint32_t database::get_slot_at_time(fc::time_point_sec when)const
 {
+   const witness_schedule_cache* schedule = get_witness_schedule_cache();
+   if( schedule != nullptr )
+      return schedule->get_slot_at_time( when );
+
    fc::time_point_sec first_slot_time = get_slot_time( 1 );
    if( when < first_slot_time )
       return 0;
@@ -84,7 +96,7 @@ uint32_t database::update_witness_missed_blocks( const signed_block& b )
    uint32_t missed_blocks = get_slot_at_time( b.timestamp );
    FC_ASSERT( missed_blocks != 0, "Trying to push double-produced block onto current block?!" );
    missed_blocks--;
-   const auto& witnesses = witness_schedule_id_type()(*this).current_shuffled_witnesses;
+   const auto& witnesses = get_witness_schedule_object().current_shuffled_witnesses;
    if( missed_blocks < witnesses.size() )
       for( uint32_t i = 0; i < missed_blocks; ++i ) {
          const auto& witness_missed = get_scheduled_witness( i+1 )(*this);
@@ -134,6 +146,29 @@ void database::update_witness_schedule()
          }
       });
    }
+
+   refresh_witness_schedule_cache();
+}
+
+void database::refresh_witness_schedule_cache()
+{
+   // invalidate first, so that get_slot_time() below reads the objects
+   _witness_schedule_cache.witnesses.clear();
+
+   const dynamic_global_property_object& dpo = get_dynamic_global_properties();
+   const witness_schedule_object& wso = get_witness_schedule_object();
+   if( wso.current_shuffled_witnesses.empty() )
+      return;
+
+   _witness_schedule_cache.current_aslot = dpo.current_aslot;
+   _witness_schedule_cache.first_slot_time = get_slot_time( 1 );
+   _witness_schedule_cache.block_interval = block_interval();
+   _witness_schedule_cache.signing_keys.clear();
+   _witness_schedule_cache.signing_keys.reserve( wso.current_shuffled_witnesses.size() );
+   for( const witness_id_type& w : wso.current_shuffled_witnesses )
+      _witness_schedule_cache.signing_keys.push_back( w(*this).signing_key );
+   _witness_schedule_cache.witnesses = wso.current_shuffled_witnesses;
+   _witness_schedule_cache.head_block_id = dpo.head_block_id;
 }
 
 } }
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2019 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/chain/execution_profiler.hpp>
+
+#include <graphene/db/object_database.hpp>
+
+namespace graphene { namespace chain {
+
+execution_profiler::scoped_phase::scoped_phase( execution_profiler& profiler, const char* name )
+   : _profiler( profiler ), _name( name )
+{
+   if( _profiler._history_size == 0 )
+      return;
+   _start = fc::time_point::now();
+   _start_changes = _profiler._db.get_object_changes();
+}
+
+execution_profiler::scoped_phase::~scoped_phase()
+{
+   if( _profiler._history_size == 0 )
+      return;
+   phase_profile phase;
+   phase.name = _name;
+   phase.microseconds = ( fc::time_point::now() - _start ).count();
+   phase.object_changes = _profiler._db.get_object_changes() - _start_changes;
+   _profiler._current.phases.push_back( std::move( phase ) );
+}
+
+execution_profiler::execution_profiler( const db::object_database& db, size_t history_size )
+   : _db( db ), _history_size( history_size ) {}
+
+void execution_profiler::set_history_size( size_t history_size )
+{
+   _history_size = history_size;
+   while( _profiles.size() > _history_size )
+      _profiles.pop_front();
+}
+
+void execution_profiler::begin( uint32_t block_num, fc::time_point_sec block_time )
+{
+   if( _history_size == 0 )
+      return;
+   // a run that was aborted by an exception is dropped
+   _current = execution_profile();
+   _current.block_num = block_num;
+   _current.block_time = block_time;
+   _start = fc::time_point::now();
+   _start_changes = _db.get_object_changes();
+}
+
+const execution_profile* execution_profiler::end()
+{
+   if( _history_size == 0 )
+      return nullptr;
+   _current.microseconds = ( fc::time_point::now() - _start ).count();
+   _current.object_changes = _db.get_object_changes() - _start_changes;
+   if( _profiles.size() >= _history_size )
+      _profiles.pop_front();
+   _profiles.push_back( std::move( _current ) );
+   _current = execution_profile();
+   return &_profiles.back();
+}
+
+vector<execution_profile> execution_profiler::get_profiles( uint32_t limit )const
+{
+   vector<execution_profile> result;
+   result.reserve( std::min<size_t>( limit, _profiles.size() ) );
+   for( auto itr = _profiles.rbegin(); itr != _profiles.rend() && result.size() < limit; ++itr )
+      result.push_back( *itr );
+   return result;
+}
+
+} } // graphene::chain
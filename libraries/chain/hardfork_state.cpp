@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2019 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <graphene/chain/hardfork_state.hpp>
+#include <graphene/chain/global_property_object.hpp>
+#include <graphene/chain/hardfork.hpp>
+
+#include <boost/preprocessor/cat.hpp>
+#include <boost/preprocessor/seq/for_each.hpp>
+
+namespace graphene { namespace chain {
+
+#define GRAPHENE_UPDATE_HARDFORK_FLAG( r, maint_time, hf ) \
+   _passed[ static_cast<size_t>( maintenance_hardfork::hf ) ] \
+      = ( maint_time > BOOST_PP_CAT( BOOST_PP_CAT( HARDFORK_, hf ), _TIME ) );
+
+void hardfork_state::update( fc::time_point_sec next_maintenance_time )
+{
+   BOOST_PP_SEQ_FOR_EACH( GRAPHENE_UPDATE_HARDFORK_FLAG, next_maintenance_time, GRAPHENE_MAINTENANCE_HARDFORKS )
+   _next_maintenance_time = next_maintenance_time;
+}
+
+#undef GRAPHENE_UPDATE_HARDFORK_FLAG
+
+void hardfork_state_index::object_inserted( const graphene::db::object& obj )
+{
+   const auto& dgpo = static_cast< const dynamic_global_property_object& >( obj );
+   if( dgpo.next_maintenance_time != _state.next_maintenance_time() )
+      _state.update( dgpo.next_maintenance_time );
+}
+
+void hardfork_state_index::object_modified( const graphene::db::object& after )
+{
+   object_inserted( after );
+}
+
+} } // graphene::chain
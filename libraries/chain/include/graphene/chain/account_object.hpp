@@ -416,6 +416,7 @@ namespace graphene { namespace chain {
 
    struct by_owner;
    struct by_maintenance_seq;
+   struct by_pending_fees;
 
    /**
     * @ingroup object_index
@@ -432,6 +433,13 @@ namespace graphene { namespace chain {
                const_mem_fun<account_statistics_object, bool, &account_statistics_object::need_maintenance>,
                member<account_statistics_object, string, &account_statistics_object::name>
             >
+         >,
+         ordered_unique< tag<by_pending_fees>,
+            composite_key<
+               account_statistics_object,
+               const_mem_fun<account_statistics_object, bool, &account_statistics_object::has_pending_fees>,
+               member<account_statistics_object, string, &account_statistics_object::name>
+            >
          >
       >
    > account_stats_multi_index_type;
@@ -53,6 +53,18 @@ struct budget_record
    share_type supply_delta = 0;
 };
 
+/**
+ * @brief Outcome of the budget of the next maintenance, computed without changing the chain state
+ */
+struct budget_simulation
+{
+   /// the maintenance time that was simulated
+   fc::time_point_sec time;
+   budget_record record;
+   /// pay of each worker, in the order the workers are paid
+   vector< std::pair< worker_id_type, share_type > > worker_pay;
+};
+
 class budget_record_object : public graphene::db::abstract_object<budget_record_object>
 {
    public:
@@ -69,6 +81,8 @@ MAP_OBJECT_ID_TO_TYPE(graphene::chain::budget_record_object)
 
 FC_REFLECT_TYPENAME( graphene::chain::budget_record )
 FC_REFLECT_TYPENAME( graphene::chain::budget_record_object )
+FC_REFLECT_TYPENAME( graphene::chain::budget_simulation )
 
 GRAPHENE_DECLARE_EXTERNAL_SERIALIZATION( graphene::chain::budget_record )
 GRAPHENE_DECLARE_EXTERNAL_SERIALIZATION( graphene::chain::budget_record_object )
+GRAPHENE_DECLARE_EXTERNAL_SERIALIZATION( graphene::chain::budget_simulation )
@@ -30,8 +30,11 @@
 
 #define GRAPHENE_MAX_NESTED_OBJECTS (200)
 
-#define GRAPHENE_CURRENT_DB_VERSION                          "20190818"
+#define GRAPHENE_CURRENT_DB_VERSION                          "20261018"
 
 #define GRAPHENE_RECENTLY_MISSED_COUNT_INCREMENT             4
 #define GRAPHENE_RECENTLY_MISSED_COUNT_DECREMENT             3
 
+/// Maximum number of accounts whose pending fees are paid out per block, after the deferred fees hardfork
+#define GRAPHENE_MAX_FEE_PROCESSING_ACCOUNTS_PER_BLOCK       1000
+
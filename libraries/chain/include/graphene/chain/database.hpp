@@ -33,6 +33,9 @@
 #include <graphene/chain/block_database.hpp>
 #include <graphene/chain/genesis_state.hpp>
 #include <graphene/chain/evaluator.hpp>
+#include <graphene/chain/execution_profiler.hpp>
+#include <graphene/chain/hardfork_state.hpp>
+#include <graphene/chain/witness_schedule_object.hpp>
 
 #include <graphene/db/object_database.hpp>
 #include <graphene/db/object.hpp>
@@ -59,6 +62,7 @@ namespace graphene { namespace chain {
    class call_order_object;
 
    struct budget_record;
+   struct budget_simulation;
    enum class vesting_balance_type;
 
    /**
@@ -166,6 +170,44 @@ namespace graphene { namespace chain {
             const fc::ecc::private_key& block_signing_private_key
             );
 
+         /**
+          * Decides in which order pending transactions are tried when generating a block.
+          * Receives the pending transactions and returns their indexes in the desired order.
+          */
+         using block_assembly_strategy =
+               std::function< vector<size_t>( const database&, const vector<processed_transaction>& ) >;
+
+         /// Keeps the order in which the transactions arrived, this is the default
+         static vector<size_t> order_by_arrival( const database& db, const vector<processed_transaction>& trxs );
+
+         /// Orders by required fees per byte, transactions which share a fee payer keep their order of arrival
+         static vector<size_t> order_by_fee_per_byte( const database& db, const vector<processed_transaction>& trxs );
+
+         /**
+          * Set the strategy used by @ref generate_block to order pending transactions
+          * @param keep_fee_payer_order whether to also postpone the later transactions of the fee payers of a
+          *        transaction which is postponed, needed by strategies which may reorder them
+          */
+         void set_block_assembly_strategy( const block_assembly_strategy& strategy, bool keep_fee_payer_order )
+         {
+            _block_assembly_strategy = strategy;
+            _keep_fee_payer_order = keep_fee_payer_order;
+         }
+
+         /// Statistics about the last block generated by @ref generate_block
+         struct block_assembly_stats
+         {
+            uint32_t candidates = 0;         ///< number of pending transactions
+            uint32_t included = 0;           ///< transactions included in the block
+            uint32_t postponed_by_size = 0;  ///< transactions which did not fit into the block
+            uint32_t postponed_by_payer = 0; ///< transactions of fee payers which had a transaction postponed
+            uint32_t failed = 0;             ///< transactions which failed to apply
+            uint64_t fees = 0;               ///< sum of fees paid in core asset by included transactions
+            uint64_t block_size = 0;
+            uint64_t maximum_block_size = 0;
+         };
+         const block_assembly_stats& get_last_block_assembly_stats()const { return _last_block_assembly_stats; }
+
          void pop_block();
          void clear_pending();
 
@@ -257,6 +299,17 @@ namespace graphene { namespace chain {
 
          void update_witness_schedule();
 
+         /**
+          * @brief The witness schedule as of the head block
+          * @return nullptr if the cache does not describe the head block, e.g. after a block was popped or while
+          *         a block is being applied
+          */
+         const witness_schedule_cache* get_witness_schedule_cache()const
+         {
+            return ( !_witness_schedule_cache.witnesses.empty()
+                     && _witness_schedule_cache.head_block_id == head_block_id() ) ? &_witness_schedule_cache : nullptr;
+         }
+
          //////////////////// db_getter.cpp ////////////////////
 
          const chain_id_type&                   get_chain_id()const;
@@ -269,6 +322,8 @@ namespace graphene { namespace chain {
          const fee_schedule&                    current_fee_schedule()const;
          const account_statistics_object&       get_account_stats_by_owner( account_id_type owner )const;
          const witness_schedule_object&         get_witness_schedule_object()const;
+         /// Which hard forks taking effect at maintenance are in effect as of next_maintenance_time
+         const hardfork_state&                  get_hardfork_state()const;
 
          time_point_sec   head_block_time()const;
          uint32_t         head_block_num()const;
@@ -444,6 +499,25 @@ namespace graphene { namespace chain {
          /// Enable or disable tracking of votes of standby witnesses and committee members
          inline void enable_standby_votes_tracking(bool enable)  { _track_standby_votes = enable; }
 
+         /// Phases of the last chain maintenance runs
+         const execution_profiler& get_maintenance_profiler()const { return _maintenance_profiler; }
+         /// Phases of the housekeeping of the last blocks, after their transactions were applied
+         const execution_profiler& get_block_profiler()const { return _block_profiler; }
+         /// Sets the number of maintenance runs and blocks to keep profiles of, 0 disables profiling
+         void set_profile_history_size( size_t maintenance_runs, size_t blocks )
+         {
+            _maintenance_profiler.set_history_size( maintenance_runs );
+            _block_profiler.set_history_size( blocks );
+         }
+
+         /**
+          * @brief Computes the budget and the worker pay of the next maintenance as of the current state
+          *
+          * Nothing is written to the database. Votes, fees and everything else maintenance would do before
+          * processing the budget are taken as they are now.
+          */
+         budget_simulation simulate_budget()const;
+
          /** Precomputes digests, signatures and operation validations depending
           *  on skip flags. "Expensive" computations may be done in a parallel
           *  thread.
@@ -489,11 +563,50 @@ namespace graphene { namespace chain {
          processed_transaction apply_transaction( const signed_transaction& trx, uint32_t skip = skip_nothing );
          operation_result      apply_operation( transaction_evaluation_state& eval_state, const operation& op );
 
+         /// Drops cached authorities and authority check results of the given account,
+         /// needs to be called whenever the owner or active authority of an account is changed
+         void                  invalidate_cached_authorities( account_id_type account );
+
       private:
          void                  _apply_block( const signed_block& next_block );
          processed_transaction _apply_transaction( const signed_transaction& trx );
          void                  _cancel_bids_and_revive_mpa( const asset_object& bitasset, const asset_bitasset_data_object& bad );
 
+         //////////////////// db_market.cpp ////////////////////
+
+         /// Balance, statistics and fee changes of cancelled limit orders, collected so that they can be applied
+         /// with one modification per object when many orders are cancelled at once
+         struct limit_order_refunds
+         {
+            struct statistics_delta
+            {
+               share_type pending_fees;
+               share_type pending_vested_fees;
+               share_type core_in_orders;
+            };
+            struct fee_delta
+            {
+               share_type accumulated_fees;
+               share_type fee_pool;
+            };
+
+            /// Balances to adjust in the order they were first touched, so that new balance objects get the same IDs
+            vector< std::pair< std::pair< account_id_type, asset_id_type >, share_type > > balances;
+            map< std::pair< account_id_type, asset_id_type >, size_t >                     balance_positions;
+            map< account_id_type, statistics_delta >                                        statistics;
+            map< asset_id_type, fee_delta >                                                 fees;
+
+            void add_balance( account_id_type account, const asset& delta );
+         };
+         /// Removes the order and pushes its virtual operation, the refunds are only collected in @p refunds
+         void collect_limit_order_refunds( const limit_order_object& order, bool create_virtual_op, bool skip_cancel_fee,
+                                           limit_order_refunds& refunds );
+         void apply_limit_order_refunds( const limit_order_refunds& refunds );
+         /// Implements check_call_orders(), AllHardforksPassed drops the code paths of old hard forks
+         template< bool AllHardforksPassed >
+         bool check_call_orders( const asset_object& mia, bool enable_black_swan, bool for_new_limit_order,
+                                 const asset_bitasset_data_object& bitasset );
+
          ///Steps involved in applying a new block
          ///@{
 
@@ -526,17 +639,24 @@ namespace graphene { namespace chain {
          //////////////////// db_maint.cpp ////////////////////
 
          void initialize_budget_record( fc::time_point_sec now, budget_record& rec )const;
+         /// Computes the budget of the maintenance at @p now and the pay of each worker, in the order they are paid
+         void compute_budget( fc::time_point_sec now, fc::time_point_sec next_maintenance_time, budget_record& rec,
+                              vector< std::pair< worker_id_type, share_type > >& worker_pay )const;
+         /// Computes the pay of the workers active at @p now from @p budget, which is reduced by the pay
+         void compute_worker_pay( fc::time_point_sec now, share_type& budget,
+                                  vector< std::pair< worker_id_type, share_type > >& worker_pay )const;
          void process_budget();
-         void pay_workers( share_type& budget );
          void perform_chain_maintenance(const signed_block& next_block, const global_property_object& global_props);
          void update_active_witnesses();
          void update_active_committee_members();
          void update_worker_votes();
          void process_bids( const asset_bitasset_data_object& bad );
          void process_bitassets();
+         /// Pays out pending fees of a bounded number of accounts, after the deferred fees hardfork
+         void process_deferred_fees();
 
          template<class Type>
-         void perform_account_maintenance( Type tally_helper );
+         void perform_account_maintenance( Type tally_helper, bool process_fees );
          ///@}
          ///@}
 
@@ -580,6 +700,9 @@ namespace graphene { namespace chain {
          /// Set it to true to provide accurate data to API clients, set to false to have better performance.
          bool                              _track_standby_votes = true;
 
+         execution_profiler                _maintenance_profiler { *this, 10 };
+         execution_profiler                _block_profiler { *this, 100 };
+
          /**
           * Whether database is successfully opened or not.
           *
@@ -595,6 +718,13 @@ namespace graphene { namespace chain {
          /// Tracks assets affected by bitshares-core issue #453 before hard fork #615 in one block
          flat_set<asset_id_type>           _issue_453_affected_assets;
 
+         /// Caches authorities and authority check results while verifying the transactions of a block
+         optional<authority_check_cache>   _authority_check_cache;
+
+         block_assembly_strategy           _block_assembly_strategy = order_by_arrival;
+         bool                              _keep_fee_payer_order = false;
+         block_assembly_stats              _last_block_assembly_stats;
+
          /// Pointers to core asset object and global objects who will have immutable addresses after created
          ///@{
          const asset_object*                    _p_core_asset_obj          = nullptr;
@@ -604,6 +734,13 @@ namespace graphene { namespace chain {
          const chain_property_object*           _p_chain_property_obj      = nullptr;
          const witness_schedule_object*         _p_witness_schedule_obj    = nullptr;
          ///@}
+
+         /// Refreshed at the end of update_witness_schedule()
+         witness_schedule_cache            _witness_schedule_cache;
+
+         /// Follows next_maintenance_time of the dynamic global properties
+         const hardfork_state_index*       _hardfork_state_index = nullptr;
+         void refresh_witness_schedule_cache();
    };
 
    namespace detail
@@ -79,7 +79,7 @@ struct pending_transactions_restorer
       for( const auto& tx : _db._popped_tx )
       {
          try {
-            if( !_db.is_known_transaction( tx.id() ) ) {
+            if( !is_obsolete( tx ) ) {
                _db._push_transaction( tx );
             }
          } catch ( const fc::exception& ) { // ignore invalid transactions
@@ -90,7 +90,7 @@ struct pending_transactions_restorer
       {
          try
          {
-            if( !_db.is_known_transaction( tx.id() ) ) {
+            if( !is_obsolete( tx ) ) {
                _db._push_transaction( tx );
             }
          }
@@ -100,6 +100,16 @@ struct pending_transactions_restorer
       }
    }
 
+   /**
+    * Whether the transaction is already included in the chain or expired.
+    * Such transactions are dropped without trying to apply them, which would fail with an exception.
+    */
+   bool is_obsolete( const precomputable_transaction& tx )const
+   {
+      return ( _db.head_block_num() > 0 && tx.expiration < _db.head_block_time() )
+             || _db.is_known_transaction( tx.id() );
+   }
+
    database& _db;
    std::vector< processed_transaction > _pending_transactions;
 };
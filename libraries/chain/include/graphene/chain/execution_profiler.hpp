@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2019 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <graphene/chain/types.hpp>
+
+#include <fc/time.hpp>
+
+#include <deque>
+
+namespace graphene { namespace db { class object_database; } }
+
+namespace graphene { namespace chain {
+
+   /// Wall time and number of object changes of one phase of a run
+   struct phase_profile
+   {
+      string   name;
+      int64_t  microseconds = 0;
+      uint64_t object_changes = 0;
+   };
+
+   /// One chain maintenance, or the housekeeping after the transactions of one block
+   struct execution_profile
+   {
+      uint32_t              block_num = 0;
+      fc::time_point_sec    block_time;
+      int64_t               microseconds = 0;
+      uint64_t              object_changes = 0;
+      vector<phase_profile> phases;
+   };
+
+   /**
+    *  @brief Records the time spent in the phases of a recurring task and keeps the profiles of its last runs
+    *
+    *  A run is started with @ref begin and finished with @ref end, the phases in between are recorded by
+    *  @ref scoped_phase objects. Object changes are counted by the object database, so they include created and
+    *  removed objects.
+    */
+   class execution_profiler
+   {
+      public:
+         /// Records the phase from its construction to its destruction in the current run
+         class scoped_phase
+         {
+            public:
+               scoped_phase( execution_profiler& profiler, const char* name );
+               ~scoped_phase();
+
+            private:
+               execution_profiler& _profiler;
+               const char*         _name;
+               fc::time_point      _start;
+               uint64_t            _start_changes;
+         };
+
+         execution_profiler( const db::object_database& db, size_t history_size );
+
+         /// Sets the number of runs to keep, 0 disables recording
+         void set_history_size( size_t history_size );
+         size_t get_history_size()const { return _history_size; }
+
+         void begin( uint32_t block_num, fc::time_point_sec block_time );
+         /// Finishes the current run, returns nullptr if recording is disabled
+         const execution_profile* end();
+
+         /// Runs the function as a phase of the current run
+         template<typename Function>
+         void run_phase( const char* name, Function&& f )
+         {
+            scoped_phase phase( *this, name );
+            f();
+         }
+
+         /// Returns the profiles of the last runs, most recent first
+         vector<execution_profile> get_profiles( uint32_t limit )const;
+
+      private:
+         const db::object_database&    _db;
+         size_t                        _history_size;
+         std::deque<execution_profile> _profiles;
+         execution_profile             _current;
+         fc::time_point                _start;
+         uint64_t                      _start_changes = 0;
+   };
+
+} }
+
+FC_REFLECT( graphene::chain::phase_profile, (name)(microseconds)(object_changes) )
+FC_REFLECT( graphene::chain::execution_profile,
+            (block_num)(block_time)(microseconds)(object_changes)(phases) )
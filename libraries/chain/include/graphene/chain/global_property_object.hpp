@@ -104,6 +104,12 @@ namespace graphene { namespace chain {
 
          uint32_t last_irreversible_block_num = 0;
 
+         /**
+          * After the deferred fees hardfork, pending fees are paid out in the blocks after maintenance, in the
+          * order of account names. This is the name to continue with, or null if all accounts are done.
+          */
+         optional<string> next_fee_processing_account;
+
          enum dynamic_flag_bits
          {
             /**
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2019 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <graphene/db/index.hpp>
+
+#include <fc/time.hpp>
+
+#include <boost/preprocessor/seq/enum.hpp>
+#include <boost/preprocessor/seq/size.hpp>
+
+#include <bitset>
+
+namespace graphene { namespace chain {
+
+/**
+ * Hard forks which take effect at the first maintenance interval after their time, i.e. whose rules apply when
+ * next_maintenance_time > HARDFORK_<name>_TIME. Each of them needs to be defined in hardfork.d, new ones are
+ * appended so that the list stays ordered by time.
+ */
+#define GRAPHENE_MAINTENANCE_HARDFORKS \
+   (CORE_184)(CORE_338)(CORE_342)(CORE_343)(CORE_453)(CORE_606)(CORE_625)(CORE_834) \
+   (CORE_868_890)(CORE_922_931)(CORE_935)(CORE_1270)(CORE_DEFERRED_FEES) \
+   (CORE_UNFILLABLE_BUYBACK)
+
+enum class maintenance_hardfork
+{
+   BOOST_PP_SEQ_ENUM( GRAPHENE_MAINTENANCE_HARDFORKS )
+};
+
+/**
+ * @brief Which of the @ref GRAPHENE_MAINTENANCE_HARDFORKS are in effect
+ *
+ * The flags only change with next_maintenance_time and are computed once for each value of it,
+ * see @ref hardfork_state_index.
+ *
+ * Code which checks many hard forks can be instantiated once for the case that all of them are in effect, which
+ * is the case on the live chain, and once for replaying history. Checking with before<true>() in the former
+ * lets the compiler drop the historical code paths. Use passed_up_to() with the latest of the checked hard forks
+ * to choose, so that scheduled hard forks don't disable the former.
+ */
+class hardfork_state
+{
+   public:
+      /// Computes the flags for the given maintenance time
+      void update( fc::time_point_sec next_maintenance_time );
+
+      /// The maintenance time the flags were computed for
+      fc::time_point_sec next_maintenance_time()const { return _next_maintenance_time; }
+
+      bool passed( maintenance_hardfork hf )const { return _passed[ static_cast<size_t>( hf ) ]; }
+      bool all_passed()const { return _passed.all(); }
+      /// Whether @p hf and all hard forks listed before it are in effect
+      bool passed_up_to( maintenance_hardfork hf )const
+      {
+         for( size_t i = 0; i <= static_cast<size_t>( hf ); ++i )
+            if( !_passed[i] )
+               return false;
+         return true;
+      }
+
+      /// Whether the rules from before the hard fork apply, always false if AllPassed is true
+      template< bool AllPassed = false >
+      bool before( maintenance_hardfork hf )const { return !AllPassed && !passed( hf ); }
+
+   private:
+      std::bitset< BOOST_PP_SEQ_SIZE( GRAPHENE_MAINTENANCE_HARDFORKS ) > _passed;
+      fc::time_point_sec _next_maintenance_time;
+};
+
+/**
+ *  @brief This secondary index of the dynamic global properties keeps the @ref hardfork_state of their
+ *         next_maintenance_time.
+ *
+ *  The flags are only computed when next_maintenance_time changes, which includes changes that are undone when
+ *  blocks are popped or pending transactions are dropped, and loading the object from disk.
+ */
+class hardfork_state_index : public graphene::db::secondary_index
+{
+   public:
+      virtual void object_inserted( const graphene::db::object& obj ) override;
+      virtual void object_modified( const graphene::db::object& after ) override;
+
+      const hardfork_state& get_state()const { return _state; }
+
+   private:
+      hardfork_state _state;
+};
+
+} } // graphene::chain
@@ -28,11 +28,49 @@
 #include <graphene/protocol/asset.hpp>
 
 #include <boost/multi_index/composite_key.hpp>
+#include <boost/multi_index/hashed_index.hpp>
+
+#include <fc/uint128.hpp>
+
+#include <stack>
 
 namespace graphene { namespace chain {
 
 using namespace graphene::db;
 
+/**
+ *  @brief A sorting key which orders prices like the price comparison operators do, but is cheaper to compare
+ *
+ *  Besides the price it holds base amount / quote amount as a 64.64 fixed-point number rounded down. It grows
+ *  whenever the price grows, so only keys with equal fixed-point values need the multiplications done by the
+ *  price comparison operators.
+ */
+struct price_key
+{
+   price_key() = default;
+   price_key( const price& p ); // not explicit, so that indexes can still be searched with a price
+
+   /// Whether this key was built from exactly @p p, i.e. same amounts and not only the same ratio
+   bool is_key_of( const price& p )const
+   { return value.base == p.base && value.quote == p.quote; }
+
+   price         value;
+   fc::uint128_t fixed_point = 0;
+   bool          has_fixed_point = false; ///< false if an amount is not positive, then only the price is compared
+
+   friend bool operator < ( const price_key& a, const price_key& b )
+   {
+      if( a.value.base.asset_id != b.value.base.asset_id )
+         return a.value.base.asset_id < b.value.base.asset_id;
+      if( a.value.quote.asset_id != b.value.quote.asset_id )
+         return a.value.quote.asset_id < b.value.quote.asset_id;
+      if( a.has_fixed_point && b.has_fixed_point && a.fixed_point != b.fixed_point )
+         return a.fixed_point < b.fixed_point;
+      return a.value < b.value;
+   }
+   friend bool operator > ( const price_key& a, const price_key& b ) { return b < a; }
+};
+
 /**
  *  @brief an offer to sell a amount of a asset at a specified exchange rate by a certain time
  *  @ingroup object
@@ -65,6 +103,17 @@ class limit_order_object : public abstract_object<limit_order_object>
       asset amount_to_receive()const { return amount_for_sale() * sell_price; }
       asset_id_type sell_asset_id()const    { return sell_price.base.asset_id;  }
       asset_id_type receive_asset_id()const { return sell_price.quote.asset_id; }
+
+      /// Sorting key of @ref sell_price, rebuilt when it is accessed after the price has been changed
+      const price_key& get_sell_price_key()const
+      {
+         if( !_sell_price_key.is_key_of( sell_price ) )
+            _sell_price_key = price_key( sell_price );
+         return _sell_price_key;
+      }
+
+   private:
+      mutable price_key _sell_price_key;
 };
 
 struct by_price;
@@ -82,10 +131,10 @@ typedef multi_index_container<
       >,
       ordered_unique< tag<by_price>,
          composite_key< limit_order_object,
-            member< limit_order_object, price, &limit_order_object::sell_price>,
+            const_mem_fun< limit_order_object, const price_key&, &limit_order_object::get_sell_price_key >,
             member< object, object_id_type, &object::id>
          >,
-         composite_key_compare< std::greater<price>, std::less<object_id_type> >
+         composite_key_compare< std::greater<price_key>, std::less<object_id_type> >
       >,
       ordered_unique< tag<by_account>,
          composite_key< limit_order_object,
@@ -100,6 +149,56 @@ typedef multi_index_container<
 
 typedef generic_index<limit_order_object, limit_order_multi_index_type> limit_order_index;
 
+/**
+ *  @brief This secondary index keeps the limit orders of every market in a separate order book,
+ *         so that matching and the market APIs only need to search the orders of one market.
+ *
+ *  A book side contains the orders selling one asset for another one, sorted from the greatest price to the least,
+ *  and by ID (i.e. in arrival order) among orders with the same price. This is the order of the @ref by_price index
+ *  of @ref limit_order_index restricted to one side of one market.
+ */
+class limit_order_book_index : public secondary_index
+{
+   public:
+      /// Sorting key of an order, keeps a copy of the price so that the entry can be found while the order is modified
+      struct order_key
+      {
+         price_key      sell_price;
+         object_id_type id;
+      };
+
+      /// Sorts by price from greatest to least then by ID, also allows looking up a price alone
+      struct order_key_compare
+      {
+         typedef void is_transparent;
+
+         bool operator()( const order_key& a, const order_key& b )const
+         {
+            if( a.sell_price > b.sell_price ) return true;
+            if( b.sell_price > a.sell_price ) return false;
+            return a.id < b.id;
+         }
+         bool operator()( const order_key& a, const price_key& b )const { return a.sell_price > b; }
+         bool operator()( const price_key& a, const order_key& b )const { return a > b.sell_price; }
+      };
+
+      typedef std::map< order_key, const limit_order_object*, order_key_compare > book_side;
+
+      virtual void object_inserted( const object& obj ) override;
+      virtual void object_removed( const object& obj ) override;
+      virtual void about_to_modify( const object& before ) override;
+      virtual void object_modified( const object& after  ) override;
+
+      /// @return the orders selling @p sell_asset for @p receive_asset, the returned reference stays valid
+      const book_side& get_orders( asset_id_type sell_asset, asset_id_type receive_asset )const;
+
+   private:
+      /** Maps each (sell asset, receive asset) pair to its book side, sides are never removed
+       *  so that iterators held by the matching engine stay valid while orders are filled */
+      std::map< std::pair< asset_id_type, asset_id_type >, book_side > books;
+      std::stack< price > prices_being_modified;
+};
+
 /**
  * @class call_order_object
  * @brief tracks debt and call price information
@@ -148,6 +247,17 @@ class call_order_object : public abstract_object<call_order_object>
                                         price feed_price,
                                         const uint16_t maintenance_collateral_ratio,
                                         const optional<price>& maintenance_collateralization = optional<price>() )const;
+
+      /// Sorting key of @ref call_price, rebuilt when it is accessed after the price has been changed
+      const price_key& get_call_price_key()const
+      {
+         if( !_call_price_key.is_key_of( call_price ) )
+            _call_price_key = price_key( call_price );
+         return _call_price_key;
+      }
+
+   private:
+      mutable price_key _call_price_key;
 };
 
 /**
@@ -194,6 +304,7 @@ class collateral_bid_object : public abstract_object<collateral_bid_object>
 struct by_collateral;
 struct by_account;
 struct by_price;
+struct by_borrower_debt;
 typedef multi_index_container<
    call_order_object,
    indexed_by<
@@ -201,10 +312,10 @@ typedef multi_index_container<
          member< object, object_id_type, &object::id > >,
       ordered_unique< tag<by_price>,
          composite_key< call_order_object,
-            member< call_order_object, price, &call_order_object::call_price>,
+            const_mem_fun< call_order_object, const price_key&, &call_order_object::get_call_price_key >,
             member< object, object_id_type, &object::id>
          >,
-         composite_key_compare< std::less<price>, std::less<object_id_type> >
+         composite_key_compare< std::less<price_key>, std::less<object_id_type> >
       >,
       ordered_unique< tag<by_account>,
          composite_key< call_order_object,
@@ -212,6 +323,13 @@ typedef multi_index_container<
             const_mem_fun< call_order_object, asset_id_type, &call_order_object::debt_type>
          >
       >,
+      // constant time lookup of the position of a borrower, by_account is for ranges of positions
+      hashed_unique< tag<by_borrower_debt>,
+         composite_key< call_order_object,
+            member< call_order_object, account_id_type, &call_order_object::borrower >,
+            const_mem_fun< call_order_object, asset_id_type, &call_order_object::debt_type>
+         >
+      >,
       ordered_unique< tag<by_collateral>,
          composite_key< call_order_object,
             const_mem_fun< call_order_object, price, &call_order_object::collateralization >,
@@ -268,6 +386,43 @@ typedef generic_index<call_order_object, call_order_multi_index_type>
 typedef generic_index<force_settlement_object, force_settlement_object_multi_index_type>   force_settlement_index;
 typedef generic_index<collateral_bid_object, collateral_bid_object_multi_index_type>       collateral_bid_index;
 
+/**
+ * @brief Tracks the call orders of every debt asset ordered by collateralization
+ *
+ * The least collateralized call order decides whether a market can be margin called or has to be globally
+ * settled, this index provides it without searching through the call orders of all assets.
+ */
+class margin_call_trigger_index : public secondary_index
+{
+   public:
+      virtual void object_inserted( const object& obj ) override;
+      virtual void object_removed( const object& obj ) override;
+      virtual void about_to_modify( const object& before ) override;
+      virtual void object_modified( const object& after  ) override;
+
+      /// @return the call order of @p debt_asset with the least collateralization, or nullptr if there is none
+      const call_order_object* get_least_collateralized( asset_id_type debt_asset )const;
+
+   private:
+      /// Sorting key of a position, keeps a copy of the collateralization so that it can be found while modified
+      struct position_key
+      {
+         price_key      collateralization;
+         object_id_type id;
+
+         friend bool operator < ( const position_key& a, const position_key& b )
+         {
+            if( a.collateralization < b.collateralization ) return true;
+            if( b.collateralization < a.collateralization ) return false;
+            return a.id < b.id;
+         }
+      };
+
+      /// Maps each debt asset to its call orders, sorted from least to most collateralized
+      std::map< asset_id_type, std::map< position_key, const call_order_object* > > positions;
+      std::stack< price > collateralizations_being_modified;
+};
+
 } } // graphene::chain
 
 MAP_OBJECT_ID_TO_TYPE(graphene::chain::limit_order_object)
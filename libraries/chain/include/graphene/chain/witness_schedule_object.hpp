@@ -36,6 +36,48 @@ class witness_schedule_object : public graphene::db::abstract_object<witness_sch
       vector< witness_id_type > current_shuffled_witnesses;
 };
 
+/**
+ * @brief Copy of the witness schedule as of a head block, so that slot lookups are plain arithmetic
+ *
+ * It is refreshed by database::update_witness_schedule() and only describes the state after the block
+ * @ref head_block_id was applied, see database::get_witness_schedule_cache().
+ */
+struct witness_schedule_cache
+{
+   block_id_type              head_block_id;
+   uint64_t                   current_aslot = 0;
+   /// time of slot 1
+   fc::time_point_sec         first_slot_time;
+   uint32_t                   block_interval = 0;
+   /// witnesses in the order they are scheduled, and their signing keys
+   vector< witness_id_type >  witnesses;
+   vector< public_key_type >  signing_keys;
+
+   witness_id_type get_scheduled_witness( uint32_t slot_num )const
+   {
+      return witnesses[ ( current_aslot + slot_num ) % witnesses.size() ];
+   }
+
+   const public_key_type& get_scheduled_signing_key( uint32_t slot_num )const
+   {
+      return signing_keys[ ( current_aslot + slot_num ) % signing_keys.size() ];
+   }
+
+   fc::time_point_sec get_slot_time( uint32_t slot_num )const
+   {
+      if( slot_num == 0 )
+         return fc::time_point_sec();
+      return first_slot_time + ( slot_num - 1 ) * block_interval;
+   }
+
+   uint32_t get_slot_at_time( fc::time_point_sec when )const
+   {
+      if( when < first_slot_time )
+         return 0;
+      return (when - first_slot_time).to_seconds() / block_interval + 1;
+   }
+};
+
 } }
 
 MAP_OBJECT_ID_TO_TYPE(graphene::chain::witness_schedule_object)
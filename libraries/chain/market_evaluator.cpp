@@ -125,7 +125,7 @@ object_id_type limit_order_create_evaluator::do_apply(const limit_order_create_o
    });
    limit_order_id_type order_id = new_order_object.id; // save this because we may remove the object by filling it
    bool filled;
-   if( db().get_dynamic_global_properties().next_maintenance_time <= HARDFORK_CORE_625_TIME )
+   if( db().get_hardfork_state().before( maintenance_hardfork::CORE_625 ) )
       filled = db().apply_order_before_hardfork_625( new_order_object );
    else
       filled = db().apply_order( new_order_object );
@@ -167,7 +167,7 @@ asset limit_order_cancel_evaluator::do_apply(const limit_order_cancel_operation&
 
    d.cancel_limit_order(*_order, false /* don't create a virtual op*/);
 
-   if( d.get_dynamic_global_properties().next_maintenance_time <= HARDFORK_CORE_606_TIME )
+   if( d.get_hardfork_state().before( maintenance_hardfork::CORE_606 ) )
    {
       // Possible optimization: order can be called by canceling a limit order iff the canceled order was at the top of the book.
       // Do I need to check calls in both assets?
@@ -261,10 +261,10 @@ object_id_type call_order_update_evaluator::do_apply(const call_order_update_ope
       }
    }
 
-   const auto next_maint_time = d.get_dynamic_global_properties().next_maintenance_time;
-   bool before_core_hardfork_1270 = ( next_maint_time <= HARDFORK_CORE_1270_TIME ); // call price caching issue
+   // call price caching issue
+   bool before_core_hardfork_1270 = d.get_hardfork_state().before( maintenance_hardfork::CORE_1270 );
 
-   auto& call_idx = d.get_index_type<call_order_index>().indices().get<by_account>();
+   auto& call_idx = d.get_index_type<call_order_index>().indices().get<by_borrower_debt>();
    auto itr = call_idx.find( boost::make_tuple(o.funding_account, o.delta_debt.asset_id) );
    const call_order_object* call_obj = nullptr;
    call_order_id_type call_order_id;
@@ -303,6 +303,103 @@ share_type call_order_object::get_max_debt_to_cover( price match_price,
 
 } FC_CAPTURE_AND_RETHROW( (*this)(feed_price)(match_price)(maintenance_collateral_ratio) ) }
 
+price_key::price_key( const price& p ) : value( p )
+{
+   // amounts are at most 63 bits, so the shifted base amount always fits
+   if( p.base.amount.value > 0 && p.quote.amount.value > 0 )
+   {
+      fixed_point = ( fc::uint128_t( p.base.amount.value ) << 64 ) / p.quote.amount.value;
+      has_fixed_point = true;
+   }
+}
+
+void limit_order_book_index::object_inserted( const object& obj )
+{
+   const auto& o = static_cast< const limit_order_object& >( obj );
+   auto& side = books[ std::make_pair( o.sell_asset_id(), o.receive_asset_id() ) ];
+   side[ order_key{ o.get_sell_price_key(), o.id } ] = &o;
+}
+
+void limit_order_book_index::object_removed( const object& obj )
+{
+   const auto& o = static_cast< const limit_order_object& >( obj );
+   auto itr = books.find( std::make_pair( o.sell_asset_id(), o.receive_asset_id() ) );
+   if( itr != books.end() )
+      itr->second.erase( order_key{ o.get_sell_price_key(), o.id } );
+}
+
+void limit_order_book_index::about_to_modify( const object& before )
+{
+   prices_being_modified.push( static_cast< const limit_order_object& >( before ).sell_price );
+}
+
+void limit_order_book_index::object_modified( const object& after )
+{
+   const auto& o = static_cast< const limit_order_object& >( after );
+   const price old_price = prices_being_modified.top();
+   prices_being_modified.pop();
+   // usually only the amount for sale changes, then the entry and iterators pointing to it are left untouched
+   if( old_price.base == o.sell_price.base && old_price.quote == o.sell_price.quote )
+      return;
+   auto itr = books.find( std::make_pair( old_price.base.asset_id, old_price.quote.asset_id ) );
+   if( itr != books.end() )
+      itr->second.erase( order_key{ price_key( old_price ), o.id } );
+   object_inserted( o );
+}
+
+const limit_order_book_index::book_side& limit_order_book_index::get_orders( asset_id_type sell_asset,
+                                                                             asset_id_type receive_asset )const
+{
+   static const book_side _empty;
+
+   auto itr = books.find( std::make_pair( sell_asset, receive_asset ) );
+   if( itr == books.end() ) return _empty;
+   return itr->second;
+}
+
+void margin_call_trigger_index::object_inserted( const object& obj )
+{
+   const auto& o = static_cast< const call_order_object& >( obj );
+   positions[ o.debt_type() ][ position_key{ price_key( o.collateralization() ), o.id } ] = &o;
+}
+
+void margin_call_trigger_index::object_removed( const object& obj )
+{
+   const auto& o = static_cast< const call_order_object& >( obj );
+   auto itr = positions.find( o.debt_type() );
+   if( itr == positions.end() )
+      return;
+   itr->second.erase( position_key{ price_key( o.collateralization() ), o.id } );
+   if( itr->second.empty() )
+      positions.erase( itr );
+}
+
+void margin_call_trigger_index::about_to_modify( const object& before )
+{
+   collateralizations_being_modified.push( static_cast< const call_order_object& >( before ).collateralization() );
+}
+
+void margin_call_trigger_index::object_modified( const object& after )
+{
+   const auto& o = static_cast< const call_order_object& >( after );
+   const price old_collateralization = collateralizations_being_modified.top();
+   collateralizations_being_modified.pop();
+   // e.g. only the target collateral ratio or the cached call price changed
+   if( old_collateralization.base == o.get_collateral() && old_collateralization.quote == o.get_debt() )
+      return;
+   auto itr = positions.find( old_collateralization.quote.asset_id );
+   if( itr != positions.end() )
+      itr->second.erase( position_key{ price_key( old_collateralization ), o.id } );
+   object_inserted( o );
+}
+
+const call_order_object* margin_call_trigger_index::get_least_collateralized( asset_id_type debt_asset )const
+{
+   auto itr = positions.find( debt_asset );
+   if( itr == positions.end() || itr->second.empty() ) return nullptr;
+   return itr->second.begin()->second;
+}
+
 FC_REFLECT_DERIVED_NO_TYPENAME( graphene::chain::limit_order_object,
                     (graphene::db::object),
                     (expiration)(seller)(for_sale)(sell_price)(deferred_fee)(deferred_paid_fee)
@@ -153,6 +153,9 @@ namespace graphene { namespace db {
 
          fc::path get_data_dir()const { return _data_dir; }
 
+         /// Number of objects created, modified or removed so far, including changes that were undone
+         uint64_t get_object_changes()const { return _object_changes; }
+
          /** public for testing purposes only... should be private in practice. */
          undo_database                          _undo_db;
      protected:
@@ -176,6 +179,7 @@ namespace graphene { namespace db {
 
          fc::path                                                  _data_dir;
          vector< vector< unique_ptr<index> > >                     _index;
+         uint64_t                                                  _object_changes = 0;
    };
 
 } } // graphene::db
@@ -132,16 +132,19 @@ void object_database::pop_undo()
 
 void object_database::save_undo( const object& obj )
 {
+   ++_object_changes;
    _undo_db.on_modify( obj );
 }
 
 void object_database::save_undo_add( const object& obj )
 {
+   ++_object_changes;
    _undo_db.on_create( obj );
 }
 
 void object_database::save_undo_remove(const object& obj)
 {
+   ++_object_changes;
    _undo_db.on_remove( obj );
 }
 
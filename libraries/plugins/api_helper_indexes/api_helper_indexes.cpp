@@ -40,11 +40,10 @@ void amount_in_collateral_index::object_inserted( const object& objct )
    }
 
    {
-      auto itr = backing_collateral.find( o.debt_type() );
-      if( itr == backing_collateral.end() )
-         backing_collateral[o.debt_type()] = o.collateral;
-      else
-         itr->second += o.collateral;
+      debt_position_stats& stats = debt_positions[o.debt_type()];
+      stats.total_debt += o.debt;
+      stats.total_collateral += o.collateral;
+      ++stats.positions;
    }
 
 } FC_CAPTURE_AND_RETHROW( (objct) ); }
@@ -60,9 +59,13 @@ void amount_in_collateral_index::object_removed( const object& objct )
    }
 
    {
-      auto itr = backing_collateral.find( o.debt_type() );
-      if( itr != backing_collateral.end() ) // should always be true
-         itr->second -= o.collateral;
+      auto itr = debt_positions.find( o.debt_type() );
+      if( itr != debt_positions.end() ) // should always be true
+      {
+         itr->second.total_debt -= o.debt;
+         itr->second.total_collateral -= o.collateral;
+         --itr->second.positions;
+      }
    }
 
 } FC_CAPTURE_AND_RETHROW( (objct) ); }
@@ -86,11 +89,179 @@ share_type amount_in_collateral_index::get_amount_in_collateral( const asset_id_
 
 share_type amount_in_collateral_index::get_backing_collateral( const asset_id_type& asset )const
 { try {
-   auto itr = backing_collateral.find( asset );
-   if( itr == backing_collateral.end() ) return 0;
+   auto itr = debt_positions.find( asset );
+   if( itr == debt_positions.end() ) return 0;
+   return itr->second.total_collateral;
+} FC_CAPTURE_AND_RETHROW( (asset) ); }
+
+debt_position_stats amount_in_collateral_index::get_debt_position_stats( const asset_id_type& asset )const
+{ try {
+   auto itr = debt_positions.find( asset );
+   if( itr == debt_positions.end() ) return debt_position_stats();
    return itr->second;
 } FC_CAPTURE_AND_RETHROW( (asset) ); }
 
+void order_book_cache_index::invalidate( const object& objct )
+{
+   if( books.empty() )
+      return;
+   const limit_order_object& o = static_cast<const limit_order_object&>( objct );
+   books.erase( std::make_pair( o.sell_asset_id(), o.receive_asset_id() ) );
+   books.erase( std::make_pair( o.receive_asset_id(), o.sell_asset_id() ) );
+}
+
+void order_book_cache_index::object_inserted( const object& objct )
+{
+   invalidate( objct );
+}
+
+void order_book_cache_index::object_removed( const object& objct )
+{
+   invalidate( objct );
+}
+
+void order_book_cache_index::about_to_modify( const object& objct )
+{
+   invalidate( objct );
+}
+
+void order_book_cache_index::object_modified( const object& objct )
+{
+   invalidate( objct );
+}
+
+std::shared_ptr<const order_book_cache_index::market_orders> order_book_cache_index::find_order_book(
+      asset_id_type base, asset_id_type quote, uint32_t limit )const
+{
+   auto itr = books.find( std::make_pair( base, quote ) );
+   if( itr == books.end() )
+      return nullptr;
+   const cached_book& cached = itr->second;
+   // a side with less orders than it was read for contains all orders of that side
+   if( limit <= cached.limit
+         || ( cached.orders->bids.size() < cached.limit && cached.orders->asks.size() < cached.limit ) )
+      return cached.orders;
+   return nullptr;
+}
+
+void order_book_cache_index::store_order_book( asset_id_type base, asset_id_type quote, uint32_t limit,
+                                               std::shared_ptr<const market_orders> orders )const
+{
+   auto key = std::make_pair( base, quote );
+   if( books.size() >= max_cached_markets && books.find( key ) == books.end() )
+      return;
+   cached_book& cached = books[ key ];
+   cached.limit = limit;
+   cached.orders = std::move( orders );
+}
+
+void market_depth_index::add_to_level( const object& objct, bool remove )
+{
+   const limit_order_object& o = static_cast<const limit_order_object&>( objct );
+   auto side_key = std::make_pair( o.sell_asset_id(), o.receive_asset_id() );
+   side_levels& side = sides[ side_key ];
+   auto itr = side.live.find( o.sell_price );
+   if( !remove )
+   {
+      if( itr == side.live.end() )
+         side.live[ o.sell_price ] = o.for_sale;
+      else
+         itr->second += o.for_sale;
+   }
+   else if( itr != side.live.end() ) // should always be true
+   {
+      itr->second -= o.for_sale;
+      if( itr->second == 0 )
+         side.live.erase( itr );
+   }
+   side.touched.insert( o.sell_price );
+   touched_sides.insert( side_key );
+}
+
+void market_depth_index::object_inserted( const object& objct )
+{ try {
+   add_to_level( objct, false );
+} FC_CAPTURE_AND_RETHROW( (objct) ); }
+
+void market_depth_index::object_removed( const object& objct )
+{ try {
+   add_to_level( objct, true );
+} FC_CAPTURE_AND_RETHROW( (objct) ); }
+
+void market_depth_index::about_to_modify( const object& objct )
+{ try {
+   add_to_level( objct, true );
+} FC_CAPTURE_AND_RETHROW( (objct) ); }
+
+void market_depth_index::object_modified( const object& objct )
+{ try {
+   add_to_level( objct, false );
+} FC_CAPTURE_AND_RETHROW( (objct) ); }
+
+void market_depth_index::publish( uint32_t block_num )
+{
+   map< std::pair<asset_id_type,asset_id_type>, market_update > updates;
+   for( const auto& side_key : touched_sides )
+   {
+      auto side_itr = sides.find( side_key );
+      if( side_itr == sides.end() )
+         continue;
+      side_levels& side = side_itr->second;
+      auto market = ( side_key.first < side_key.second ? side_key : std::make_pair( side_key.second, side_key.first ) );
+      for( const price& level : side.touched )
+      {
+         auto live_itr = side.live.find( level );
+         share_type live_amount = ( live_itr == side.live.end() ? share_type( 0 ) : live_itr->second );
+         auto published_itr = side.published.find( level );
+         if( published_itr == side.published.end() )
+         {
+            if( live_amount == 0 )
+               continue;
+            side.published[ live_itr->first ] = live_amount;
+         }
+         else if( published_itr->second == live_amount )
+            continue;
+         else if( live_amount == 0 )
+            side.published.erase( published_itr );
+         else
+            published_itr->second = live_amount;
+         updates[ market ].levels.emplace_back( level, live_amount );
+      }
+      side.touched.clear();
+      if( side.live.empty() && side.published.empty() )
+         sides.erase( side_itr );
+   }
+   touched_sides.clear();
+
+   published_updates.clear();
+   published_updates.reserve( updates.size() );
+   for( auto& item : updates )
+   {
+      item.second.market = item.first;
+      item.second.sequence = ++sequences[ item.first ];
+      published_updates.emplace_back( std::move( item.second ) );
+   }
+   published_block_num = block_num;
+}
+
+const market_depth_index::depth_side& market_depth_index::get_published_levels( asset_id_type sell_asset,
+                                                                                asset_id_type receive_asset )const
+{
+   static const depth_side _empty;
+
+   auto itr = sides.find( std::make_pair( sell_asset, receive_asset ) );
+   if( itr == sides.end() ) return _empty;
+   return itr->second.published;
+}
+
+uint64_t market_depth_index::get_sequence( asset_id_type a, asset_id_type b )const
+{
+   if( a > b ) std::swap( a, b );
+   auto itr = sequences.find( std::make_pair( a, b ) );
+   if( itr == sequences.end() ) return 0;
+   return itr->second;
+}
+
 namespace detail
 {
 
@@ -149,6 +320,14 @@ void api_helper_indexes::plugin_startup()
    amount_in_collateral = database().add_secondary_index< primary_index<call_order_index>, amount_in_collateral_index >();
    for( const auto& call : database().get_index_type<call_order_index>().indices() )
       amount_in_collateral->object_inserted( call );
+   order_book_cache = database().add_secondary_index< primary_index<limit_order_index>, order_book_cache_index >();
+   market_depth = database().add_secondary_index< primary_index<limit_order_index>, market_depth_index >();
+   for( const auto& order : database().get_index_type<limit_order_index>().indices() )
+      market_depth->object_inserted( order );
+   market_depth->publish( database().head_block_num() );
+   database().applied_block.connect( [this]( const signed_block& b ) {
+      market_depth->publish( b.block_num() );
+   });
 }
 
 } }
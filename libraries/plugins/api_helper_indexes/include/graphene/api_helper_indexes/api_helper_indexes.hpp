@@ -24,14 +24,26 @@
 #pragma once
 
 #include <graphene/app/plugin.hpp>
+#include <graphene/chain/market_object.hpp>
+#include <graphene/protocol/asset.hpp>
 #include <graphene/protocol/types.hpp>
 
 namespace graphene { namespace api_helper_indexes {
 using namespace chain;
 
 /**
- *  @brief This secondary index tracks how much of each asset is locked up as collateral for MPAs, and how much
- *         collateral is backing an MPA in total.
+ *  @brief Aggregated debt positions of an MPA
+ */
+struct debt_position_stats
+{
+   share_type total_debt;        ///< total debt of all positions, in the MPA
+   share_type total_collateral;  ///< total collateral backing the MPA
+   uint32_t   positions = 0;     ///< number of debt positions
+};
+
+/**
+ *  @brief This secondary index tracks how much of each asset is locked up as collateral for MPAs, and aggregates
+ *         the debt positions of each MPA.
  */
 class amount_in_collateral_index : public secondary_index
 {
@@ -43,10 +55,117 @@ class amount_in_collateral_index : public secondary_index
 
       share_type get_amount_in_collateral( const asset_id_type& asset )const;
       share_type get_backing_collateral( const asset_id_type& asset )const;
+      debt_position_stats get_debt_position_stats( const asset_id_type& asset )const;
 
    private:
       flat_map<asset_id_type, share_type> in_collateral;
-      flat_map<asset_id_type, share_type> backing_collateral;
+      flat_map<asset_id_type, debt_position_stats> debt_positions;
+};
+
+/**
+ *  @brief This secondary index caches the orders read by the database API for order books, so that tickers and
+ *         order book snapshots of busy API nodes don't have to walk the limit order index again for every call.
+ *
+ *  The orders are cached as they are stored in the chain state and formatted by every request, since the precision
+ *  of an asset may still change. The cached orders of a market are dropped whenever one of its limit orders is
+ *  created, modified or removed, including changes made by pending transactions or undone by switching forks, so
+ *  the cache never serves outdated data. Orders are only kept for @ref max_cached_markets markets at a time.
+ *
+ *  Like the other indexes of this plugin, the cache is only accessed on the main thread, which applies blocks and
+ *  also runs the API calls.
+ */
+class order_book_cache_index : public secondary_index
+{
+   public:
+      static const size_t max_cached_markets = 2000;
+
+      /// Orders of a market, best price first
+      struct market_orders
+      {
+         vector<limit_order_object> bids; ///< orders selling the base asset
+         vector<limit_order_object> asks; ///< orders selling the quote asset
+      };
+
+      virtual void object_inserted( const object& obj ) override;
+      virtual void object_removed( const object& obj ) override;
+      virtual void about_to_modify( const object& before ) override;
+      virtual void object_modified( const object& after ) override;
+
+      /// @return the cached orders of @p base / @p quote if they hold the best @p limit orders of each side,
+      ///         nullptr otherwise, the result may contain more orders than requested
+      std::shared_ptr<const market_orders> find_order_book( asset_id_type base, asset_id_type quote,
+                                                            uint32_t limit )const;
+      /// Caches the orders of @p base / @p quote that were read with at most @p limit orders per side
+      void store_order_book( asset_id_type base, asset_id_type quote, uint32_t limit,
+                             std::shared_ptr<const market_orders> orders )const;
+
+   private:
+      struct cached_book
+      {
+         uint32_t                             limit = 0;
+         std::shared_ptr<const market_orders> orders;
+      };
+
+      void invalidate( const object& obj );
+
+      /// Cached orders by market, keyed by the asset IDs in the order of the request
+      mutable map< std::pair<asset_id_type,asset_id_type>, cached_book > books;
+};
+
+/**
+ *  @brief This secondary index aggregates limit orders into price levels, and publishes the levels that changed
+ *         in every block so that the depth of a market can be streamed to API clients.
+ *
+ *  Two views are kept: the live levels including pending transactions, and the levels published with the last
+ *  block. Snapshots are served from the published view, so they match the sequence numbers of the updates.
+ */
+class market_depth_index : public secondary_index
+{
+   public:
+      /// Aggregated amount for sale by price, best price first
+      typedef std::map< price, share_type, std::greater<price> > depth_side;
+
+      /// Levels of a market that changed in a block, an amount of zero removes the level
+      struct market_update
+      {
+         std::pair<asset_id_type,asset_id_type>   market;    ///< ordered by asset ID
+         uint64_t                                 sequence = 0;
+         vector< std::pair<price,share_type> >    levels;
+      };
+
+      virtual void object_inserted( const object& obj ) override;
+      virtual void object_removed( const object& obj ) override;
+      virtual void about_to_modify( const object& before ) override;
+      virtual void object_modified( const object& after ) override;
+
+      /// Compares the live levels touched since the last call with the published ones and publishes the changes
+      void publish( uint32_t block_num );
+
+      uint32_t get_published_block_num()const { return published_block_num; }
+      /// @return the updates published for @ref get_published_block_num
+      const vector<market_update>& get_published_updates()const { return published_updates; }
+      /// @return the published levels of the orders selling @p sell_asset for @p receive_asset
+      const depth_side& get_published_levels( asset_id_type sell_asset, asset_id_type receive_asset )const;
+      /// @return the number of updates published for the market of @p a and @p b
+      uint64_t get_sequence( asset_id_type a, asset_id_type b )const;
+
+   private:
+      struct side_levels
+      {
+         depth_side              live;
+         depth_side              published;
+         std::set<price>         touched;
+      };
+
+      void add_to_level( const object& obj, bool remove );
+
+      /// Levels by (sell asset, receive asset)
+      map< std::pair<asset_id_type,asset_id_type>, side_levels >   sides;
+      set< std::pair<asset_id_type,asset_id_type> >                touched_sides;
+      map< std::pair<asset_id_type,asset_id_type>, uint64_t >      sequences;
+
+      uint32_t                                                     published_block_num = 0;
+      vector<market_update>                                        published_updates;
 };
 
 namespace detail
@@ -73,6 +192,10 @@ class api_helper_indexes : public graphene::app::plugin
 
    private:
       amount_in_collateral_index* amount_in_collateral = nullptr;
+      order_book_cache_index* order_book_cache = nullptr;
+      market_depth_index* market_depth = nullptr;
 };
 
 } } //graphene::template
+
+FC_REFLECT( graphene::api_helper_indexes::debt_position_stats, (total_debt)(total_collateral)(positions) )
@@ -26,6 +26,10 @@
 
 #include <graphene/chain/market_object.hpp>
 
+#include <fc/uint128.hpp>
+
+#include <array>
+
 namespace graphene { namespace grouped_orders {
 
 namespace detail
@@ -49,11 +53,19 @@ class grouped_orders_plugin_impl
 
 /**
  *  @brief This secondary index is used to track changes on limit order objects.
+ *
+ *  Orders are put into buckets of quantized price: with a group of g, bucket k of a market contains the orders whose
+ *  price is in [ (1+g/10000)^k, (1+g/10000)^(k+1) ). The logarithms are calculated with integers in fixed point, so
+ *  that the bucket of a price doesn't depend on the floating point implementation. The buckets of every market and
+ *  group are kept in pages of @ref bucket_page_size consecutive buckets, so that adding or removing an order only
+ *  touches its own bucket.
  */
 class limit_order_group_index : public secondary_index
 {
    public:
-      limit_order_group_index( const flat_set<uint16_t>& groups ) : _tracked_groups( groups ) {};
+      static const int32_t bucket_page_size = 32;
+
+      limit_order_group_index( const flat_set<uint16_t>& groups );
 
       virtual void object_inserted( const object& obj ) override;
       virtual void object_removed( const object& obj ) override;
@@ -63,128 +75,197 @@ class limit_order_group_index : public secondary_index
       const flat_set<uint16_t>& get_tracked_groups() const
       { return _tracked_groups; }
 
-      const map< limit_order_group_key, limit_order_group_data >& get_order_groups() const
-      { return _og_data; }
+      vector< std::pair<limit_order_group_key,limit_order_group_data> > get_order_groups(
+            asset_id_type base, asset_id_type quote, uint16_t group, const price& max_price, uint32_t limit )const;
 
    private:
-      void remove_order( const limit_order_object& obj, bool remove_empty = true );
+      struct bucket
+      {
+         /** number of orders by price, the first and the last price are the price range of the bucket */
+         std::map< price, uint32_t > prices;
+         share_type    total_for_sale;
+      };
+
+      struct bucket_page
+      {
+         std::array< bucket, bucket_page_size > buckets;
+         uint32_t      orders = 0;
+      };
+
+      /** pages of a market and group, keyed by the index of their first bucket divided by bucket_page_size */
+      typedef flat_map< int32_t, bucket_page > bucket_pages;
+
+      typedef std::pair< asset_id_type, asset_id_type > market_type;
+
+      int32_t bucket_index( size_t group_pos, const price& p )const;
+
+      void insert_order( const limit_order_object& o );
+      void remove_order( const limit_order_object& o, bool remove_empty = true );
+      void remove_empty_pages( const price& p );
 
       /** tracked groups */
       flat_set<uint16_t> _tracked_groups;
 
-      /** maps the group key to group data */
-      map< limit_order_group_key, limit_order_group_data > _og_data;
-};
+      /** log2( 1 + group / 10000 ) in fixed point for every tracked group, in the same order as _tracked_groups */
+      vector<int64_t> _log_steps;
 
-void limit_order_group_index::object_inserted( const object& objct )
-{ try {
-   const limit_order_object& o = static_cast<const limit_order_object&>( objct );
+      /** maps the market to the bucket pages of each tracked group, in the same order as _tracked_groups */
+      map< market_type, vector<bucket_pages> > _og_data;
+
+      /** price of the order being modified */
+      optional<price> _modified_price;
+};
 
-   auto& idx = _og_data;
+/**
+ *  @return log2( r / 2^64 ) with 32 fractional bits, rounded down
+ *  @param r a positive number with 64 fractional bits
+ */
+static int64_t fixed_point_log2( fc::uint128_t r )
+{
+   // scale r into [ 2^63, 2^64 ), i.e. [ 1, 2 ) with 63 fractional bits
+   const fc::uint128_t two = fc::uint128_t( 1 ) << 64;
+   int64_t exponent = -1;
+   while( r >= two )
+   {
+      r >>= 1;
+      ++exponent;
+   }
+   while( r < ( two >> 1 ) )
+   {
+      r <<= 1;
+      --exponent;
+   }
 
-   for( uint16_t group : get_tracked_groups() )
+   // squaring the mantissa doubles its logarithm, every overflow beyond 2 is the next fractional bit
+   int64_t result = exponent * ( int64_t( 1 ) << 32 );
+   for( int64_t bit = int64_t( 1 ) << 31; bit > 0; bit >>= 1 )
    {
-      auto create_ogo = [&]() {
-         idx[ limit_order_group_key( group, o.sell_price ) ] = limit_order_group_data( o.sell_price, o.for_sale );
-      };
-      // if idx is empty, insert this order
-      // Note: not capped
-      if( idx.empty() )
+      r = ( r * r ) >> 63;
+      if( r >= two )
       {
-         create_ogo();
-         continue;
+         r >>= 1;
+         result += bit;
       }
+   }
+   return result;
+}
 
-      // cap the price
-      price capped_price = o.sell_price;
-      price max = o.sell_price.max();
-      price min = o.sell_price.min();
-      bool capped_max = false;
-      bool capped_min = false;
-      if( o.sell_price > max )
-      {
-         capped_price = max;
-         capped_max = true;
-      }
-      else if( o.sell_price < min )
+limit_order_group_index::limit_order_group_index( const flat_set<uint16_t>& groups ) : _tracked_groups( groups )
+{
+   for( uint16_t group : _tracked_groups )
+      _log_steps.push_back( fixed_point_log2( ( fc::uint128_t( GRAPHENE_100_PERCENT + group ) << 64 )
+                                              / GRAPHENE_100_PERCENT ) );
+}
+
+int32_t limit_order_group_index::bucket_index( size_t group_pos, const price& p )const
+{
+   // the amounts of a limit order price are positive, the caller checks other prices,
+   // the amounts are at most 63 bits, so the shifted base amount always fits
+   const int64_t l = fixed_point_log2( ( fc::uint128_t( p.base.amount.value ) << 64 ) / p.quote.amount.value );
+   const int64_t step = _log_steps[group_pos];
+   // round down, l is at most 64 * 2^32 in magnitude and step is at least log2( 1.0001 ) * 2^32,
+   // so the result fits with a good margin
+   return int32_t( l >= 0 ? l / step : -( ( -l + step - 1 ) / step ) );
+}
+
+static int32_t page_of( int32_t bucket )
+{
+   return bucket >= 0 ? bucket / limit_order_group_index::bucket_page_size
+                      : ( bucket + 1 ) / limit_order_group_index::bucket_page_size - 1;
+}
+
+void limit_order_group_index::insert_order( const limit_order_object& o )
+{
+   auto& groups = _og_data[ market_type( o.sell_price.base.asset_id, o.sell_price.quote.asset_id ) ];
+   if( groups.empty() )
+      groups.resize( _tracked_groups.size() );
+
+   for( size_t i = 0; i < groups.size(); ++i )
+   {
+      int32_t k = bucket_index( i, o.sell_price );
+      int32_t page_num = page_of( k );
+      bucket_page& page = groups[i][ page_num ];
+      bucket& b = page.buckets[ k - page_num * bucket_page_size ];
+      ++b.prices[ o.sell_price ];
+      b.total_for_sale += o.for_sale;
+      ++page.orders;
+   }
+}
+
+void limit_order_group_index::remove_order( const limit_order_object& o, bool remove_empty )
+{
+   auto market_itr = _og_data.find( market_type( o.sell_price.base.asset_id, o.sell_price.quote.asset_id ) );
+   if( market_itr == _og_data.end() )
+   {
+      // should not happen
+      wlog( "can not find the order group containing order for removing (market dismatch): ${o}", ("o",o) );
+      return;
+   }
+   auto& groups = market_itr->second;
+
+   for( size_t i = 0; i < groups.size(); ++i )
+   {
+      int32_t k = bucket_index( i, o.sell_price );
+      int32_t page_num = page_of( k );
+      auto page_itr = groups[i].find( page_num );
+      if( page_itr == groups[i].end() )
       {
-         capped_price = min;
-         capped_min = true;
+         // can not find corresponding group, should not happen
+         wlog( "can not find the order group containing order for removing (price dismatch): ${o}", ("o",o) );
+         continue;
       }
-      // if idx is not empty, find the group that is next to this order
-      auto itr = idx.lower_bound( limit_order_group_key( group, capped_price ) );
-      bool check_previous = false;
-      if( itr == idx.end() || itr->first.group != group
-            || itr->first.min_price.base.asset_id != o.sell_price.base.asset_id
-            || itr->first.min_price.quote.asset_id != o.sell_price.quote.asset_id )
-         // not same market or group type
-         check_previous = true;
-      else // same market and group type
+      bucket_page& page = page_itr->second;
+      bucket& b = page.buckets[ k - page_num * bucket_page_size ];
+      auto price_itr = b.prices.find( o.sell_price );
+      if( price_itr == b.prices.end() )
       {
-         bool update_max = false;
-         if( capped_price > itr->second.max_price ) // implies itr->min_price <= itr->max_price < max
-         {
-            update_max = true;
-            price max_price = itr->first.min_price * ratio_type( GRAPHENE_100_PERCENT + group, GRAPHENE_100_PERCENT );
-            // max_price should have been capped here
-            if( capped_price > max_price ) // new order is out of range
-               check_previous = true;
-         }
-         if( !check_previous ) // new order is within the range
-         {
-            if( capped_min && o.sell_price < itr->first.min_price )
-            {  // need to update itr->min_price here, if itr is below min, and new order is even lower
-               // TODO improve performance
-               limit_order_group_data data( itr->second.max_price, o.for_sale + itr->second.total_for_sale );
-               idx.erase( itr );
-               idx[ limit_order_group_key( group, o.sell_price ) ] = data;
-            }
-            else
-            {
-               if( update_max || ( capped_max && o.sell_price > itr->second.max_price ) )
-                  itr->second.max_price = o.sell_price; // store real price here, not capped
-               itr->second.total_for_sale += o.for_sale;
-            }
-         }
+         // can not find corresponding group, should not happen
+         wlog( "can not find the order group containing order for removing (price dismatch): ${o}", ("o",o) );
+         continue;
       }
+      FC_ASSERT( b.total_for_sale >= o.for_sale,
+                 "The order group containing the order sells less than the order: ${o}", ("o",o) );
+      b.total_for_sale -= o.for_sale;
+      if( --price_itr->second == 0 )
+         b.prices.erase( price_itr );
+      --page.orders;
+      if( remove_empty && page.orders == 0 )
+         groups[i].erase( page_itr );
+   }
 
-      if( check_previous )
-      {
-         if( itr == idx.begin() ) // no previous
-            create_ogo();
-         else
-         {
-            --itr; // should be valid
-            if( itr->first.group != group || itr->first.min_price.base.asset_id != o.sell_price.base.asset_id
-                                          || itr->first.min_price.quote.asset_id != o.sell_price.quote.asset_id )
-               // not same market or group type
-               create_ogo();
-            else // same market and group type
-            {
-               // due to lower_bound, always true: capped_price < itr->first.min_price, so no need to check again,
-               // if new order is in range of itr group, always need to update itr->first.min_price, unless
-               //   o.sell_price is higher than max
-               price min_price = itr->second.max_price / ratio_type( GRAPHENE_100_PERCENT + group, GRAPHENE_100_PERCENT );
-               // min_price should have been capped here
-               if( capped_price < min_price ) // new order is out of range
-                  create_ogo();
-               else if( capped_max && o.sell_price >= itr->first.min_price )
-               {  // itr is above max, and price of new order is even higher
-                  if( o.sell_price > itr->second.max_price )
-                     itr->second.max_price = o.sell_price;
-                  itr->second.total_for_sale += o.for_sale;
-               }
-               else
-               {  // new order is within the range
-                  // TODO improve performance
-                  limit_order_group_data data( itr->second.max_price, o.for_sale + itr->second.total_for_sale );
-                  idx.erase( itr );
-                  idx[ limit_order_group_key( group, o.sell_price ) ] = data;
-               }
-            }
-         }
-      }
+   if( remove_empty )
+   {
+      bool empty = true;
+      for( const auto& pages : groups )
+         empty = empty && pages.empty();
+      if( empty )
+         _og_data.erase( market_itr );
    }
+}
+
+void limit_order_group_index::remove_empty_pages( const price& p )
+{
+   auto market_itr = _og_data.find( market_type( p.base.asset_id, p.quote.asset_id ) );
+   if( market_itr == _og_data.end() )
+      return;
+   auto& groups = market_itr->second;
+
+   bool empty = true;
+   for( size_t i = 0; i < groups.size(); ++i )
+   {
+      auto page_itr = groups[i].find( page_of( bucket_index( i, p ) ) );
+      if( page_itr != groups[i].end() && page_itr->second.orders == 0 )
+         groups[i].erase( page_itr );
+      empty = empty && groups[i].empty();
+   }
+   if( empty )
+      _og_data.erase( market_itr );
+}
+
+void limit_order_group_index::object_inserted( const object& objct )
+{ try {
+   const limit_order_object& o = static_cast<const limit_order_object&>( objct );
+   insert_order( o );
 } FC_CAPTURE_AND_RETHROW( (objct) ); }
 
 void limit_order_group_index::object_removed( const object& objct )
@@ -196,43 +277,60 @@ void limit_order_group_index::object_removed( const object& objct )
 void limit_order_group_index::about_to_modify( const object& objct )
 { try {
    const limit_order_object& o = static_cast<const limit_order_object&>( objct );
+   // keep the pages, the order is usually added back to the same bucket
    remove_order( o, false );
+   _modified_price = o.sell_price;
 } FC_CAPTURE_AND_RETHROW( (objct) ); }
 
 void limit_order_group_index::object_modified( const object& objct )
 { try {
-   object_inserted( objct );
+   const limit_order_object& o = static_cast<const limit_order_object&>( objct );
+   insert_order( o );
+   if( _modified_price.valid() )
+   {
+      remove_empty_pages( *_modified_price );
+      _modified_price.reset();
+   }
 } FC_CAPTURE_AND_RETHROW( (objct) ); }
 
-void limit_order_group_index::remove_order( const limit_order_object& o, bool remove_empty )
+vector< std::pair<limit_order_group_key,limit_order_group_data> > limit_order_group_index::get_order_groups(
+      asset_id_type base, asset_id_type quote, uint16_t group, const price& max_price, uint32_t limit )const
 {
-   auto& idx = _og_data;
-
-   for( uint16_t group : get_tracked_groups() )
+   vector< std::pair<limit_order_group_key,limit_order_group_data> > result;
+
+   auto group_itr = _tracked_groups.find( group );
+   if( group_itr == _tracked_groups.end() )
+      return result;
+   size_t group_pos = group_itr - _tracked_groups.begin();
+
+   auto market_itr = _og_data.find( market_type( base, quote ) );
+   if( market_itr == _og_data.end() )
+      return result;
+   const bucket_pages& pages = market_itr->second[ group_pos ];
+
+   // a null price is below every bucket
+   if( max_price.quote.amount <= 0 || max_price.base.amount <= 0 )
+      return result;
+   int32_t first_bucket = bucket_index( group_pos, max_price );
+   int32_t first_page = page_of( first_bucket );
+
+   // walk the buckets from the best price downwards
+   auto page_itr = pages.upper_bound( first_page );
+   while( page_itr != pages.begin() && result.size() < limit )
    {
-      // find the group that should contain this order
-      auto itr = idx.lower_bound( limit_order_group_key( group, o.sell_price ) );
-      if( itr == idx.end() || itr->first.group != group
-            || itr->first.min_price.base.asset_id != o.sell_price.base.asset_id
-            || itr->first.min_price.quote.asset_id != o.sell_price.quote.asset_id
-            || itr->second.max_price < o.sell_price )
-      {
-         // can not find corresponding group, should not happen
-         wlog( "can not find the order group containing order for removing (price dismatch): ${o}", ("o",o) );
-         continue;
-      }
-      else // found
+      --page_itr;
+      const bucket_page& page = page_itr->second;
+      int32_t offset = ( page_itr->first == first_page ? first_bucket - first_page * bucket_page_size
+                                                       : bucket_page_size - 1 );
+      for( ; offset >= 0 && result.size() < limit; --offset )
       {
-         if( itr->second.total_for_sale < o.for_sale )
-            // should not happen
-            wlog( "can not find the order group containing order for removing (amount dismatch): ${o}", ("o",o) );
-         else if( !remove_empty || itr->second.total_for_sale > o.for_sale )
-            itr->second.total_for_sale -= o.for_sale;
-         else
-            // it's the only order in the group and need to be removed
-            idx.erase( itr );
+         const bucket& b = page.buckets[ offset ];
+         if( !b.prices.empty() )
+            result.emplace_back( limit_order_group_key( group, b.prices.begin()->first ),
+                                 limit_order_group_data( b.prices.rbegin()->first, b.total_for_sale ) );
       }
    }
+   return result;
 }
 
 grouped_orders_plugin_impl::~grouped_orders_plugin_impl()
@@ -292,12 +390,13 @@ const flat_set<uint16_t>& grouped_orders_plugin::tracked_groups() const
    return my->_tracked_groups;
 }
 
-const map< limit_order_group_key, limit_order_group_data >& grouped_orders_plugin::limit_order_groups()
+vector< std::pair<limit_order_group_key,limit_order_group_data> > grouped_orders_plugin::limit_order_groups(
+      asset_id_type base, asset_id_type quote, uint16_t group, const price& max_price, uint32_t limit )
 {
    const auto& idx = database().get_index_type< limit_order_index >();
    const auto& pidx = dynamic_cast<const primary_index< limit_order_index >&>(idx);
    const auto& logidx = pidx.get_secondary_index< detail::limit_order_group_index >();
-   return logidx.get_order_groups();
+   return logidx.get_order_groups( base, quote, group, max_price, limit );
 }
 
 } }
@@ -82,7 +82,16 @@ class grouped_orders_plugin : public graphene::app::plugin
 
       const flat_set<uint16_t>&   tracked_groups()const;
 
-      const map< limit_order_group_key, limit_order_group_data >& limit_order_groups();
+      /**
+       * @brief Get the order groups of a market, ordered from the best price to the worst
+       * @param base Asset being sold by the orders
+       * @param quote Asset being received by the orders
+       * @param group The tracked group
+       * @param max_price Return the groups starting with the one containing this price
+       * @param limit Maximum number of groups to return
+       */
+      vector< std::pair<limit_order_group_key,limit_order_group_data> > limit_order_groups(
+            asset_id_type base, asset_id_type quote, uint16_t group, const price& max_price, uint32_t limit );
 
    private:
       friend class detail::grouped_orders_plugin_impl;
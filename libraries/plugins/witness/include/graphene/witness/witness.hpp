@@ -86,7 +86,8 @@ private:
    std::set<chain::witness_id_type> _witnesses;
    fc::future<void> _block_production_task;
 
-   /// For tracking signing keys of specified witnesses, only update when applied a block
+   /// For tracking signing keys of specified witnesses, only update when applied a block.
+   /// Only used when the witness schedule cache of the database does not describe the head block.
    fc::flat_map< chain::witness_id_type, fc::optional<chain::public_key_type> > _witness_key_cache;
 
 };
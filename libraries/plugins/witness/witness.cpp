@@ -81,6 +81,10 @@ void witness_plugin::plugin_set_program_options(
           "Path to a file containing tuples of [PublicKey, WIF private key]."
           " The file has to contain exactly one tuple (i.e. private - public key pair) per line."
           " This option may be specified multiple times, thus multiple files can be provided.")
+         ("block-assembly-strategy", bpo::value<string>()->default_value("arrival"),
+          "Order in which pending transactions are included into produced blocks, "
+          "either 'arrival' (order of arrival) or 'fee-per-byte' (highest required fee per byte first, "
+          "keeping the order of transactions of the same fee payer)")
          ;
    config_file_options.add(command_line_options);
 }
@@ -164,6 +168,14 @@ void witness_plugin::plugin_initialize(const boost::program_options::variables_m
        else if(required_participation > 90)
            wlog("witness plugin: Warning - High required participation of ${rp}% found", ("rp", required_participation));
    }
+   if( options.count("block-assembly-strategy") )
+   {
+      const string strategy = options["block-assembly-strategy"].as<string>();
+      if( strategy == "fee-per-byte" )
+         database().set_block_assembly_strategy( chain::database::order_by_fee_per_byte, true );
+      else
+         FC_ASSERT( strategy == "arrival", "Unknown block assembly strategy ${s}", ("s", strategy) );
+   }
    ilog("witness plugin:  plugin_initialize() end");
 } FC_LOG_AND_RETHROW() }
 
@@ -274,7 +286,9 @@ block_production_condition::block_production_condition_enum witness_plugin::bloc
    switch( result )
    {
       case block_production_condition::produced:
-         ilog("Generated block #${n} with ${x} transaction(s) and timestamp ${t} at time ${c}", (capture));
+         ilog("Generated block #${n} with ${x} transaction(s) and timestamp ${t} at time ${c}, "
+              "filled ${s} of ${m} bytes (${p}%), postponed ${ps} for size and ${pp} for fee payer order, "
+              "dropped ${f} transaction(s)", (capture));
          break;
       case block_production_condition::not_synced:
          ilog("Not producing block because production is disabled until we receive a recent block "
@@ -352,7 +366,11 @@ block_production_condition::block_production_condition_enum witness_plugin::mayb
    }
 
    fc::time_point_sec scheduled_time = db.get_slot_time( slot );
-   graphene::chain::public_key_type scheduled_key = *_witness_key_cache[scheduled_witness]; // should be valid
+   // the schedule of the database also has the signing keys, unless it does not describe the head block
+   const chain::witness_schedule_cache* schedule = db.get_witness_schedule_cache();
+   graphene::chain::public_key_type scheduled_key = ( schedule != nullptr )
+                                                    ? schedule->get_scheduled_signing_key( slot )
+                                                    : *_witness_key_cache[scheduled_witness]; // should be valid
    auto private_key_itr = _private_keys.find( scheduled_key );
 
    if( private_key_itr == _private_keys.end() )
@@ -381,6 +399,10 @@ block_production_condition::block_production_condition_enum witness_plugin::mayb
       _production_skip_flags
       );
    capture("n", block.block_num())("t", block.timestamp)("c", now)("x", block.transactions.size());
+   const auto& stats = db.get_last_block_assembly_stats();
+   capture("s", stats.block_size)("m", stats.maximum_block_size)
+          ("p", stats.maximum_block_size == 0 ? 0 : stats.block_size * 100 / stats.maximum_block_size)
+          ("ps", stats.postponed_by_size)("pp", stats.postponed_by_payer)("f", stats.failed);
    fc::async( [this,block](){ p2p_node().broadcast(net::block_message(block)); } );
 
    return block_production_condition::produced;
@@ -22,6 +22,7 @@
  * THE SOFTWARE.
  */
 #include <graphene/protocol/asset.hpp>
+#include <graphene/protocol/fixed_point.hpp>
 #include <boost/rational.hpp>
 #include <boost/multiprecision/cpp_int.hpp>
 
@@ -58,19 +59,20 @@ namespace graphene { namespace protocol {
 
       asset operator * ( const asset& a, const price& b )
       {
+         int64_t result;
          if( a.asset_id == b.base.asset_id )
          {
             FC_ASSERT( b.base.amount.value > 0 );
-            uint128_t result = (uint128_t(a.amount.value) * b.quote.amount.value)/b.base.amount.value;
-            FC_ASSERT( result <= GRAPHENE_MAX_SHARE_SUPPLY );
-            return asset( static_cast<int64_t>(result), b.quote.asset_id );
+            FC_ASSERT( fixed_point::multiply_and_divide( a.amount.value, b.quote.amount.value, b.base.amount.value,
+                                                         result ) );
+            return asset( result, b.quote.asset_id );
          }
          else if( a.asset_id == b.quote.asset_id )
          {
             FC_ASSERT( b.quote.amount.value > 0 );
-            uint128_t result = (uint128_t(a.amount.value) * b.base.amount.value)/b.quote.amount.value;
-            FC_ASSERT( result <= GRAPHENE_MAX_SHARE_SUPPLY );
-            return asset( static_cast<int64_t>(result), b.base.asset_id );
+            FC_ASSERT( fixed_point::multiply_and_divide( a.amount.value, b.base.amount.value, b.quote.amount.value,
+                                                         result ) );
+            return asset( result, b.base.asset_id );
          }
          FC_THROW_EXCEPTION( fc::assert_exception, "invalid asset * price", ("asset",a)("price",b) );
       }
@@ -78,19 +80,20 @@ namespace graphene { namespace protocol {
       asset asset::multiply_and_round_up( const price& b )const
       {
          const asset& a = *this;
+         int64_t result;
          if( a.asset_id == b.base.asset_id )
          {
             FC_ASSERT( b.base.amount.value > 0 );
-            uint128_t result = (uint128_t(a.amount.value) * b.quote.amount.value + b.base.amount.value - 1)/b.base.amount.value;
-            FC_ASSERT( result <= GRAPHENE_MAX_SHARE_SUPPLY );
-            return asset( static_cast<int64_t>(result), b.quote.asset_id );
+            FC_ASSERT( fixed_point::multiply_and_divide_round_up( a.amount.value, b.quote.amount.value,
+                                                                  b.base.amount.value, result ) );
+            return asset( result, b.quote.asset_id );
          }
          else if( a.asset_id == b.quote.asset_id )
          {
             FC_ASSERT( b.quote.amount.value > 0 );
-            uint128_t result = (uint128_t(a.amount.value) * b.base.amount.value + b.quote.amount.value - 1)/b.quote.amount.value;
-            FC_ASSERT( result <= GRAPHENE_MAX_SHARE_SUPPLY );
-            return asset( static_cast<int64_t>(result), b.base.asset_id );
+            FC_ASSERT( fixed_point::multiply_and_divide_round_up( a.amount.value, b.base.amount.value,
+                                                                  b.quote.amount.value, result ) );
+            return asset( result, b.base.asset_id );
          }
          FC_THROW_EXCEPTION( fc::assert_exception, "invalid asset::multiply_and_round_up(price)", ("asset",a)("price",b) );
       }
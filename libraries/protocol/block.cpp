@@ -98,6 +98,15 @@ namespace graphene { namespace protocol {
       }
       return _calculated_merkle_root;
    }
+
+   uint64_t signed_block::get_packed_size()const
+   {
+      uint64_t size = fc::raw::pack_size( static_cast<const signed_block_header&>( *this ) )
+                      + fc::raw::pack_size( fc::unsigned_int( transactions.size() ) );
+      for( const auto& trx : transactions )
+         size += trx.get_full_packed_size();
+      return size;
+   }
 } }
 
 GRAPHENE_IMPLEMENT_EXTERNAL_SERIALIZATION( graphene::protocol::block_header)
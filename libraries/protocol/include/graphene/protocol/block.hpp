@@ -60,6 +60,8 @@ namespace graphene { namespace protocol {
    {
    public:
       const checksum_type& calculate_merkle_root()const;
+      /// Size of the serialized block, reusing the cached serialization of the transactions
+      uint64_t get_packed_size()const;
       vector<processed_transaction> transactions;
    protected:
       mutable checksum_type   _calculated_merkle_root;
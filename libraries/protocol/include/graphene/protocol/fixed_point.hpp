@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2019 BitShares Blockchain Foundation,, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+#include <graphene/protocol/config.hpp>
+
+#include <fc/uint128.hpp>
+
+#include <cstdint>
+
+namespace graphene { namespace protocol {
+
+/**
+ *  Fixed-point arithmetic on share amounts, as used by asset * price and the market fees.
+ *
+ *  The operands are amounts, so they are expected to be non-negative and at most GRAPHENE_MAX_SHARE_SUPPLY.
+ *  The product only needs 128 bits when an operand does not fit into 32 bits, which is rare for prices
+ *  and fee percentages, so these helpers try the 64-bit division first. The results are the same as
+ *  computing everything with fc::uint128_t.
+ *
+ *  All helpers return false instead of a result greater than GRAPHENE_MAX_SHARE_SUPPLY.
+ */
+namespace fixed_point {
+
+   /// Computes floor( a * b / c ), c must be positive
+   inline bool multiply_and_divide( int64_t a, int64_t b, int64_t c, int64_t& result )
+   {
+      if( ( ( uint64_t(a) | uint64_t(b) ) >> 32 ) == 0 )
+      {
+         const uint64_t r = ( uint64_t(a) * uint64_t(b) ) / uint64_t(c);
+         if( r > uint64_t(GRAPHENE_MAX_SHARE_SUPPLY) )
+            return false;
+         result = int64_t(r);
+         return true;
+      }
+      const fc::uint128_t r = ( fc::uint128_t(a) * b ) / c;
+      if( r > GRAPHENE_MAX_SHARE_SUPPLY )
+         return false;
+      result = static_cast<int64_t>(r);
+      return true;
+   }
+
+   /// Computes ceil( a * b / c ), c must be positive
+   inline bool multiply_and_divide_round_up( int64_t a, int64_t b, int64_t c, int64_t& result )
+   {
+      if( ( ( uint64_t(a) | uint64_t(b) ) >> 32 ) == 0 )
+      {
+         // adding c - 1 to the product could overflow 64 bits, use the remainder instead
+         const uint64_t p = uint64_t(a) * uint64_t(b);
+         const uint64_t r = p / uint64_t(c) + ( p % uint64_t(c) != 0 );
+         if( r > uint64_t(GRAPHENE_MAX_SHARE_SUPPLY) )
+            return false;
+         result = int64_t(r);
+         return true;
+      }
+      const fc::uint128_t r = ( fc::uint128_t(a) * b + c - 1 ) / c;
+      if( r > GRAPHENE_MAX_SHARE_SUPPLY )
+         return false;
+      result = static_cast<int64_t>(r);
+      return true;
+   }
+
+   /// Computes floor( value * percent / GRAPHENE_100_PERCENT )
+   inline bool percent_of( int64_t value, uint16_t percent, int64_t& result )
+   {
+      // below 2^48 the product fits into 64 bits
+      if( ( uint64_t(value) >> 48 ) == 0 )
+      {
+         const uint64_t r = ( uint64_t(value) * percent ) / GRAPHENE_100_PERCENT;
+         if( r > uint64_t(GRAPHENE_MAX_SHARE_SUPPLY) )
+            return false;
+         result = int64_t(r);
+         return true;
+      }
+      const fc::uint128_t r = ( fc::uint128_t(value) * percent ) / GRAPHENE_100_PERCENT;
+      if( r > GRAPHENE_MAX_SHARE_SUPPLY )
+         return false;
+      result = static_cast<int64_t>(r);
+      return true;
+   }
+
+} } } // graphene::protocol::fixed_point
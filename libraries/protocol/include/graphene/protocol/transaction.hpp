@@ -84,7 +84,7 @@ namespace graphene { namespace protocol {
       extensions_type    extensions;
 
       /// Calculate the digest for a transaction
-      digest_type                        digest()const;
+      virtual digest_type                digest()const;
       virtual const transaction_id_type& id()const;
       virtual void                       validate() const;
 
@@ -117,10 +117,12 @@ namespace graphene { namespace protocol {
 
    protected:
       // Calculate the digest used for signature validation
-      digest_type sig_digest( const chain_id_type& chain_id )const;
+      virtual digest_type sig_digest( const chain_id_type& chain_id )const;
       mutable transaction_id_type _tx_id_buffer;
    };
 
+   class authority_check_cache;
+
    /**
     *  @brief adds a signature to a transaction
     */
@@ -172,6 +174,16 @@ namespace graphene { namespace protocol {
          bool allow_non_immediate_owner,
          uint32_t max_recursion = GRAPHENE_MAX_SIG_CHECK_DEPTH )const;
 
+      /**
+       * Same as above, but authorities are resolved through the given cache, which also remembers results of
+       *   authority checks, so that they can be reused when verifying other transactions.
+       */
+      void verify_authority(
+         const chain_id_type& chain_id,
+         authority_check_cache& cache,
+         bool allow_non_immediate_owner,
+         uint32_t max_recursion = GRAPHENE_MAX_SIG_CHECK_DEPTH )const;
+
       /**
        * This is a slower replacement for get_required_signatures()
        * which returns a minimal set in all cases, including
@@ -224,13 +236,80 @@ namespace graphene { namespace protocol {
       precomputable_transaction( signed_transaction&& tx ) : signed_transaction( std::move(tx) ) {};
       virtual ~precomputable_transaction() = default;
 
+      virtual digest_type                      digest()const override;
       virtual const transaction_id_type&       id()const override;
       virtual void                             validate()const override;
       virtual const flat_set<public_key_type>& get_signature_keys( const chain_id_type& chain_id )const override;
       virtual uint64_t                         get_packed_size()const override;
+
+      /**
+       * @brief Returns the serialized @ref transaction part (i.e. without signatures) of this object.
+       * @note The serialization is calculated on first use and cached, it is then reused for the transaction ID,
+       *       the signature digest, the packed size and the merkle digest.
+       */
+      const vector<char>&                      get_packed_transaction()const;
+
+      /**
+       * @brief Drops all cached data.
+       *
+       * The fields of the transaction are public members of the base classes, so modifying them can not reset the
+       * cache. Like the transaction ID and the signees which were cached before, the serialization is only computed
+       * once the transaction is complete. Code which modifies a transaction after that, e.g. to re-sign it, must
+       * call this function.
+       */
+      void invalidate_cache();
    protected:
+      virtual digest_type sig_digest( const chain_id_type& chain_id )const override;
       mutable bool _validated = false;
-      mutable uint64_t _packed_size = 0;
+      mutable vector<char> _packed_trx;
+   };
+
+   /**
+    * Caches data used by @ref verify_authority so that it can be reused when verifying many transactions,
+    * E.G. all transactions of a block. Cached are
+    * - the active and owner authorities of accounts, resolved through the given callbacks,
+    * - the addresses which can be derived from public keys,
+    * - results of checking authorities which only contain keys and addresses against a set of public keys.
+    *
+    * Results are cached by the address of the authority, so the callbacks must return pointers which stay valid
+    * as long as the cache is in use, and @ref invalidate must be called when authorities of an account change.
+    */
+   class authority_check_cache
+   {
+   public:
+      /// Result of checking an authority without account authorities against a set of public keys
+      struct check_result
+      {
+         bool                    satisfied = false;
+         /// keys that were needed to satisfy the authority, the other keys would be unused
+         vector<public_key_type> used_keys;
+      };
+
+      authority_check_cache( const std::function<const authority*(account_id_type)>& get_active,
+                             const std::function<const authority*(account_id_type)>& get_owner );
+
+      const authority* get_active( account_id_type id );
+      const authority* get_owner( account_id_type id );
+
+      /// Returns all addresses which can be derived from the given key, I.E. the PTS style ones and the native one
+      const vector<address>& get_addresses( const public_key_type& key );
+
+      /// @return the cached result, or nullptr if not found
+      const check_result* find_result( const authority* auth, const flat_set<public_key_type>& sigs )const;
+      const check_result& store_result( const authority* auth, const flat_set<public_key_type>& sigs,
+                                        check_result&& result );
+
+      /// Drops everything cached about the authorities of the given account
+      void invalidate( account_id_type id );
+
+   private:
+      std::function<const authority*(account_id_type)> _get_active;
+      std::function<const authority*(account_id_type)> _get_owner;
+
+      std::map< account_id_type, const authority* >    _active;
+      std::map< account_id_type, const authority* >    _owner;
+      std::map< public_key_type, vector<address> >     _addresses;
+      std::map< const authority*, std::map< flat_set<public_key_type>, check_result > > _results;
    };
 
    /**
@@ -258,6 +337,18 @@ namespace graphene { namespace protocol {
                           const flat_set<account_id_type>& active_aprovals = flat_set<account_id_type>(),
                           const flat_set<account_id_type>& owner_approvals = flat_set<account_id_type>());
 
+   /**
+    * Same as above, but authorities are resolved through the given cache, which also remembers results of
+    * authority checks for subsequent calls.
+    */
+   void verify_authority( const vector<operation>& ops, const flat_set<public_key_type>& sigs,
+                          authority_check_cache& cache,
+                          bool allow_non_immediate_owner,
+                          uint32_t max_recursion = GRAPHENE_MAX_SIG_CHECK_DEPTH,
+                          bool allow_committe = false,
+                          const flat_set<account_id_type>& active_aprovals = flat_set<account_id_type>(),
+                          const flat_set<account_id_type>& owner_approvals = flat_set<account_id_type>());
+
    /**
     *  @brief captures the result of evaluating the operations contained in the transaction
     *
@@ -275,11 +366,17 @@ namespace graphene { namespace protocol {
    {
       processed_transaction( const signed_transaction& trx = signed_transaction() )
          : precomputable_transaction(trx){}
+      /// Keeps the data which was already precomputed for the given transaction
+      processed_transaction( const precomputable_transaction& trx )
+         : precomputable_transaction(trx){}
       virtual ~processed_transaction() = default;
 
       vector<operation_result> operation_results;
 
       digest_type merkle_digest()const;
+
+      /// Size of the full serialization, i.e. including signatures and operation results
+      uint64_t get_full_packed_size()const;
    };
 
    /// @} transactions group
@@ -34,11 +34,19 @@ namespace graphene { namespace protocol {
 
 digest_type processed_transaction::merkle_digest()const
 {
+   const vector<char>& packed_trx = get_packed_transaction();
    digest_type::encoder enc;
-   fc::raw::pack( enc, *this );
+   enc.write( packed_trx.data(), packed_trx.size() );
+   fc::raw::pack( enc, signatures );
+   fc::raw::pack( enc, operation_results );
    return enc.result();
 }
 
+uint64_t processed_transaction::get_full_packed_size()const
+{
+   return get_packed_size() + fc::raw::pack_size( signatures ) + fc::raw::pack_size( operation_results );
+}
+
 digest_type transaction::digest()const
 {
    digest_type::encoder enc;
@@ -133,24 +141,29 @@ struct sign_state
       optional<map<address,public_key_type>> available_address_sigs;
       optional<map<address,public_key_type>> provided_address_sigs;
 
+      void add_addresses( map<address,public_key_type>& address_sigs, const public_key_type& k )
+      {
+         if( cache != nullptr )
+         {
+            for( const auto& a : cache->get_addresses( k ) )
+               address_sigs[ a ] = k;
+            return;
+         }
+         address_sigs[ address(pts_address(k, false, 56) ) ] = k;
+         address_sigs[ address(pts_address(k, true, 56) ) ] = k;
+         address_sigs[ address(pts_address(k, false, 0) ) ] = k;
+         address_sigs[ address(pts_address(k, true, 0) ) ] = k;
+         address_sigs[ address(k) ] = k;
+      }
+
       bool signed_by( const address& a ) {
          if( !available_address_sigs ) {
             available_address_sigs = std::map<address,public_key_type>();
             provided_address_sigs = std::map<address,public_key_type>();
-            for( auto& item : available_keys ) {
-             (*available_address_sigs)[ address(pts_address(item, false, 56) ) ] = item;
-             (*available_address_sigs)[ address(pts_address(item, true, 56) ) ] = item;
-             (*available_address_sigs)[ address(pts_address(item, false, 0) ) ] = item;
-             (*available_address_sigs)[ address(pts_address(item, true, 0) ) ] = item;
-             (*available_address_sigs)[ address(item) ] = item;
-            }
-            for( auto& item : provided_signatures ) {
-             (*provided_address_sigs)[ address(pts_address(item.first, false, 56) ) ] = item.first;
-             (*provided_address_sigs)[ address(pts_address(item.first, true, 56) ) ] = item.first;
-             (*provided_address_sigs)[ address(pts_address(item.first, false, 0) ) ] = item.first;
-             (*provided_address_sigs)[ address(pts_address(item.first, true, 0) ) ] = item.first;
-             (*provided_address_sigs)[ address(item.first) ] = item.first;
-            }
+            for( auto& item : available_keys )
+               add_addresses( *available_address_sigs, item );
+            for( auto& item : provided_signatures )
+               add_addresses( *provided_address_sigs, item.first );
          }
          auto itr = provided_address_sigs->find(a);
          if( itr == provided_address_sigs->end() )
@@ -175,12 +188,33 @@ struct sign_state
       /**
        *  Checks to see if we have signatures of the active authorites of
        *  the accounts specified in authority or the keys specified.
+       *
+       *  @param use_cache whether the result may be cached, requires that @p au points to a persistent object
        */
-      bool check_authority( const authority* au, uint32_t depth = 0 )
+      bool check_authority( const authority* au, uint32_t depth = 0, bool use_cache = true )
       {
          if( au == nullptr ) return false;
          const authority& auth = *au;
 
+         // Without account authorities, the result only depends on the provided signatures
+         if( use_cache && cache != nullptr && available_keys.empty() && auth.account_auths.empty() )
+         {
+            const authority_check_cache::check_result* result = cache->find_result( au, signature_keys );
+            if( result == nullptr )
+            {
+               sign_state fresh( signature_keys, get_active, get_owner, allow_non_immediate_owner, max_recursion,
+                                 empty_keyset, cache );
+               authority_check_cache::check_result new_result;
+               new_result.satisfied = fresh.check_authority( au, depth, false );
+               for( const auto& sig : fresh.provided_signatures )
+                  if( sig.second ) new_result.used_keys.push_back( sig.first );
+               result = &cache->store_result( au, signature_keys, std::move( new_result ) );
+            }
+            for( const auto& k : result->used_keys )
+               provided_signatures[ k ] = true;
+            return result->satisfied;
+         }
+
          uint32_t total_weight = 0;
          for( const auto& k : auth.key_auths )
             if( signed_by( k.first ) )
@@ -240,12 +274,15 @@ struct sign_state
                   const std::function<const authority*(account_id_type)>& owner,
                   bool allow_owner,
                   uint32_t max_recursion_depth = GRAPHENE_MAX_SIG_CHECK_DEPTH,
-                  const flat_set<public_key_type>& keys = empty_keyset )
+                  const flat_set<public_key_type>& keys = empty_keyset,
+                  authority_check_cache* check_cache = nullptr )
       :  get_active(active),
          get_owner(owner),
          allow_non_immediate_owner(allow_owner),
          max_recursion(max_recursion_depth),
-         available_keys(keys)
+         available_keys(keys),
+         signature_keys(sigs),
+         cache(check_cache)
       {
          for( const auto& key : sigs )
             provided_signatures[ key ] = false;
@@ -258,20 +295,96 @@ struct sign_state
       const bool                       allow_non_immediate_owner;
       const uint32_t                   max_recursion;
       const flat_set<public_key_type>& available_keys;
+      const flat_set<public_key_type>& signature_keys;
+      authority_check_cache* const     cache;
 
       flat_map<public_key_type,bool>   provided_signatures;
       flat_set<account_id_type>        approved_by;
 };
 
 
-void verify_authority( const vector<operation>& ops, const flat_set<public_key_type>& sigs,
-                       const std::function<const authority*(account_id_type)>& get_active,
-                       const std::function<const authority*(account_id_type)>& get_owner,
-                       bool allow_non_immediate_owner,
-                       uint32_t max_recursion_depth,
-                       bool  allow_committe,
-                       const flat_set<account_id_type>& active_aprovals,
-                       const flat_set<account_id_type>& owner_approvals )
+authority_check_cache::authority_check_cache( const std::function<const authority*(account_id_type)>& get_active,
+                                              const std::function<const authority*(account_id_type)>& get_owner )
+   : _get_active( get_active ), _get_owner( get_owner )
+{
+}
+
+const authority* authority_check_cache::get_active( account_id_type id )
+{
+   auto itr = _active.find( id );
+   if( itr == _active.end() )
+      itr = _active.emplace( id, _get_active( id ) ).first;
+   return itr->second;
+}
+
+const authority* authority_check_cache::get_owner( account_id_type id )
+{
+   auto itr = _owner.find( id );
+   if( itr == _owner.end() )
+      itr = _owner.emplace( id, _get_owner( id ) ).first;
+   return itr->second;
+}
+
+const vector<address>& authority_check_cache::get_addresses( const public_key_type& key )
+{
+   auto itr = _addresses.find( key );
+   if( itr == _addresses.end() )
+   {
+      vector<address> addresses;
+      addresses.reserve( 5 );
+      addresses.emplace_back( pts_address( key, false, 56 ) );
+      addresses.emplace_back( pts_address( key, true, 56 ) );
+      addresses.emplace_back( pts_address( key, false, 0 ) );
+      addresses.emplace_back( pts_address( key, true, 0 ) );
+      addresses.emplace_back( key );
+      itr = _addresses.emplace( key, std::move( addresses ) ).first;
+   }
+   return itr->second;
+}
+
+const authority_check_cache::check_result* authority_check_cache::find_result(
+      const authority* auth, const flat_set<public_key_type>& sigs )const
+{
+   auto itr = _results.find( auth );
+   if( itr == _results.end() )
+      return nullptr;
+   auto result_itr = itr->second.find( sigs );
+   if( result_itr == itr->second.end() )
+      return nullptr;
+   return &result_itr->second;
+}
+
+const authority_check_cache::check_result& authority_check_cache::store_result(
+      const authority* auth, const flat_set<public_key_type>& sigs, check_result&& result )
+{
+   return _results[ auth ][ sigs ] = std::move( result );
+}
+
+void authority_check_cache::invalidate( account_id_type id )
+{
+   auto itr = _active.find( id );
+   if( itr != _active.end() )
+   {
+      _results.erase( itr->second );
+      _active.erase( itr );
+   }
+   itr = _owner.find( id );
+   if( itr != _owner.end() )
+   {
+      _results.erase( itr->second );
+      _owner.erase( itr );
+   }
+}
+
+static void verify_authority_impl( const vector<operation>& ops, const flat_set<public_key_type>& sigs,
+                                   const std::function<const authority*(account_id_type)>& get_active,
+                                   const std::function<const authority*(account_id_type)>& get_owner,
+                                   bool allow_non_immediate_owner,
+                                   uint32_t max_recursion_depth,
+                                   bool  allow_committe,
+                                   const flat_set<account_id_type>& active_aprovals,
+                                   const flat_set<account_id_type>& owner_approvals,
+                                   authority_check_cache* cache )
 { try {
    flat_set<account_id_type> required_active;
    flat_set<account_id_type> required_owner;
@@ -284,7 +397,7 @@ void verify_authority( const vector<operation>& ops, const flat_set<public_key_t
       GRAPHENE_ASSERT( required_active.find(GRAPHENE_COMMITTEE_ACCOUNT) == required_active.end(),
                        invalid_committee_approval, "Committee account may only propose transactions" );
 
-   sign_state s( sigs, get_active, get_owner, allow_non_immediate_owner, max_recursion_depth );
+   sign_state s( sigs, get_active, get_owner, allow_non_immediate_owner, max_recursion_depth, empty_keyset, cache );
    for( auto& id : active_aprovals )
       s.approved_by.insert( id );
    for( auto& id : owner_approvals )
@@ -292,7 +405,8 @@ void verify_authority( const vector<operation>& ops, const flat_set<public_key_t
 
    for( const auto& auth : other )
    {
-      GRAPHENE_ASSERT( s.check_authority(&auth), tx_missing_other_auth, "Missing Authority", ("auth",auth)("sigs",sigs) );
+      GRAPHENE_ASSERT( s.check_authority( &auth, 0, false ), tx_missing_other_auth, "Missing Authority",
+                       ("auth",auth)("sigs",sigs) );
    }
 
    // fetch all of the top level authorities
@@ -318,6 +432,37 @@ void verify_authority( const vector<operation>& ops, const flat_set<public_key_t
       );
 } FC_CAPTURE_AND_RETHROW( (ops)(sigs) ) }
 
+void verify_authority( const vector<operation>& ops, const flat_set<public_key_type>& sigs,
+                       const std::function<const authority*(account_id_type)>& get_active,
+                       const std::function<const authority*(account_id_type)>& get_owner,
+                       bool allow_non_immediate_owner,
+                       uint32_t max_recursion_depth,
+                       bool  allow_committe,
+                       const flat_set<account_id_type>& active_aprovals,
+                       const flat_set<account_id_type>& owner_approvals )
+{
+   verify_authority_impl( ops, sigs, get_active, get_owner, allow_non_immediate_owner, max_recursion_depth,
+                          allow_committe, active_aprovals, owner_approvals, nullptr );
+}
+
+void verify_authority( const vector<operation>& ops, const flat_set<public_key_type>& sigs,
+                       authority_check_cache& cache,
+                       bool allow_non_immediate_owner,
+                       uint32_t max_recursion_depth,
+                       bool  allow_committe,
+                       const flat_set<account_id_type>& active_aprovals,
+                       const flat_set<account_id_type>& owner_approvals )
+{
+   std::function<const authority*(account_id_type)> get_active = [&cache]( account_id_type id ) {
+      return cache.get_active( id );
+   };
+   std::function<const authority*(account_id_type)> get_owner = [&cache]( account_id_type id ) {
+      return cache.get_owner( id );
+   };
+   verify_authority_impl( ops, sigs, get_active, get_owner, allow_non_immediate_owner, max_recursion_depth,
+                          allow_committe, active_aprovals, owner_approvals, &cache );
+}
+
 
 const flat_set<public_key_type>& signed_transaction::get_signature_keys( const chain_id_type& chain_id )const
 { try {
@@ -399,6 +544,37 @@ set<public_key_type> signed_transaction::minimize_required_signatures(
    return set<public_key_type>( result.begin(), result.end() );
 }
 
+const vector<char>& precomputable_transaction::get_packed_transaction()const
+{
+   // A serialized transaction is never empty, so an empty buffer means it is not calculated yet
+   if( _packed_trx.empty() )
+      _packed_trx = fc::raw::pack( static_cast<const transaction&>( *this ) );
+   return _packed_trx;
+}
+
+void precomputable_transaction::invalidate_cache()
+{
+   _validated = false;
+   _packed_trx.clear();
+   _tx_id_buffer = transaction_id_type();
+   _signees.clear();
+}
+
+digest_type precomputable_transaction::digest()const
+{
+   const vector<char>& packed_trx = get_packed_transaction();
+   return digest_type::hash( packed_trx.data(), packed_trx.size() );
+}
+
+digest_type precomputable_transaction::sig_digest( const chain_id_type& chain_id )const
+{
+   const vector<char>& packed_trx = get_packed_transaction();
+   digest_type::encoder enc;
+   fc::raw::pack( enc, chain_id );
+   enc.write( packed_trx.data(), packed_trx.size() );
+   return enc.result();
+}
+
 const transaction_id_type& precomputable_transaction::id()const
 {
    if( !_tx_id_buffer._hash[0].value() )
@@ -415,9 +591,7 @@ void precomputable_transaction::validate() const
 
 uint64_t precomputable_transaction::get_packed_size()const
 {
-   if( _packed_size == 0 )
-      _packed_size = transaction::get_packed_size();
-   return _packed_size;
+   return get_packed_transaction().size();
 }
 
 const flat_set<public_key_type>& precomputable_transaction::get_signature_keys( const chain_id_type& chain_id )const
@@ -440,6 +614,16 @@ void signed_transaction::verify_authority(
                                          allow_non_immediate_owner, max_recursion );
 } FC_CAPTURE_AND_RETHROW( (*this) ) }
 
+void signed_transaction::verify_authority(
+   const chain_id_type& chain_id,
+   authority_check_cache& cache,
+   bool allow_non_immediate_owner,
+   uint32_t max_recursion )const
+{ try {
+   graphene::protocol::verify_authority( operations, get_signature_keys( chain_id ), cache,
+                                         allow_non_immediate_owner, max_recursion );
+} FC_CAPTURE_AND_RETHROW( (*this) ) }
+
 } } // graphene::protocol
 
 GRAPHENE_IMPLEMENT_EXTERNAL_SERIALIZATION( graphene::protocol::transaction)
@@ -198,7 +198,8 @@ database_fixture::database_fixture(const fc::time_point_sec &initial_timestamp)
     options.insert(std::make_pair("plugins", boost::program_options::variable_value(
        string("account_history"), false)));
    }
-   if( current_test_name == "asset_in_collateral" )
+   if( current_test_name == "asset_in_collateral" || current_test_name == "order_book_cache"
+         || current_test_name == "market_depth_subscription" )
    {
     options.insert( std::make_pair( "plugins",
                                     boost::program_options::variable_value( string("api_helper_indexes"), false ) ) );
@@ -278,7 +279,8 @@ database_fixture::database_fixture(const fc::time_point_sec &initial_timestamp)
       esobjects_plugin->plugin_initialize(options);
       esobjects_plugin->plugin_startup();
    }
-   else if( current_test_name == "asset_in_collateral" )
+   else if( current_test_name == "asset_in_collateral" || current_test_name == "order_book_cache"
+         || current_test_name == "market_depth_subscription" )
    {
       auto ahiplugin = app.register_plugin<graphene::api_helper_indexes::api_helper_indexes>();
       ahiplugin->plugin_set_app(&app);
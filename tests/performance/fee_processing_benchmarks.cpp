@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2019 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/hardfork.hpp>
+
+#include <graphene/chain/account_object.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+/**
+ * Simulates paying out the pending fees of many accounts, once in the maintenance block as before the deferred fees
+ * hardfork, and once spread over the following blocks as after it.
+ */
+BOOST_FIXTURE_TEST_SUITE( fee_processing_benchmarks, database_fixture )
+
+BOOST_AUTO_TEST_CASE( deferred_fee_processing_benchmark )
+{ try {
+   const uint32_t payers = 20000;
+
+   vector<account_id_type> payer_ids;
+   for( uint32_t i = 0; i < payers; ++i )
+   {
+      payer_ids.push_back( create_account( "payer" + fc::to_string(i) ).id );
+      if( i % 1000 == 999 )
+         generate_block();
+   }
+   enable_fees();
+   const int64_t fee = db.current_fee_schedule().calculate_fee( transfer_operation() ).amount.value;
+
+   signed_transaction tx;
+   auto push = [&]( account_id_type from, account_id_type to, int64_t amount ) {
+      transfer_operation op;
+      op.from = from;
+      op.to = to;
+      op.amount = asset( amount );
+      op.fee = asset( fee );
+      tx.clear();
+      set_expiration( db, tx );
+      tx.operations.push_back( op );
+      db.push_transaction( tx, ~0 );
+   };
+   auto pay_fees = [&]() {
+      for( uint32_t i = 0; i < payers; ++i )
+      {
+         push( committee_account, payer_ids[i], 2 * fee );
+         push( payer_ids[i], committee_account, 1 );
+         if( i % 500 == 499 )
+            generate_block();
+      }
+      generate_block();
+   };
+   const auto& stats_idx = db.get_index_type<account_stats_index>().indices().get<by_pending_fees>();
+   auto accounts_with_pending_fees = [&stats_idx]() -> size_t {
+      return std::distance( stats_idx.lower_bound( true ), stats_idx.end() );
+   };
+
+   // the block before the maintenance block
+   const uint32_t interval = db.get_global_properties().parameters.block_interval;
+
+   pay_fees();
+   generate_blocks( db.get_dynamic_global_properties().next_maintenance_time - interval );
+   auto start = fc::time_point::now();
+   generate_block();
+   wlog( "Maintenance block paying out fees of ${n} accounts: ${ms}ms",
+         ("n",payers)("ms",( fc::time_point::now() - start ).count() / 1000) );
+
+   generate_blocks( HARDFORK_CORE_DEFERRED_FEES_TIME );
+   generate_blocks( db.get_dynamic_global_properties().next_maintenance_time );
+
+   pay_fees();
+   generate_blocks( db.get_dynamic_global_properties().next_maintenance_time - interval );
+   start = fc::time_point::now();
+   generate_block();
+   wlog( "Maintenance block after the hardfork: ${ms}ms", ("ms",( fc::time_point::now() - start ).count() / 1000) );
+
+   uint32_t blocks = 0;
+   int64_t max_block_time = 0;
+   start = fc::time_point::now();
+   while( accounts_with_pending_fees() > 0 )
+   {
+      auto block_start = fc::time_point::now();
+      generate_block();
+      max_block_time = std::max( max_block_time, ( fc::time_point::now() - block_start ).count() );
+      ++blocks;
+   }
+   wlog( "Paid out the remaining fees in ${b} blocks, ${ms}ms in total, slowest block ${max}ms",
+         ("b",blocks)("ms",( fc::time_point::now() - start ).count() / 1000)("max",max_block_time / 1000) );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
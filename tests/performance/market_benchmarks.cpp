@@ -0,0 +1,466 @@
+/*
+ * Copyright (c) 2019 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/hardfork.hpp>
+
+#include <graphene/chain/account_object.hpp>
+#include <graphene/chain/asset_object.hpp>
+#include <graphene/chain/market_object.hpp>
+
+#include <graphene/app/api.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+namespace {
+
+/// Collects the latencies of one kind of operation and reports throughput and percentiles
+struct latency_stats
+{
+   explicit latency_stats( const string& n ) : name( n ) {}
+
+   void add( const fc::microseconds& elapsed )
+   {
+      samples.push_back( elapsed.count() );
+      total += elapsed.count();
+   }
+
+   void report()
+   {
+      if( samples.empty() )
+         return;
+      std::sort( samples.begin(), samples.end() );
+      auto percentile = [this]( size_t p ) {
+         return samples[ std::min( samples.size() - 1, samples.size() * p / 100 ) ];
+      };
+      wlog( "${name}: ${n} ops, ${ops} ops/s, latency p50 ${p50}us p90 ${p90}us p99 ${p99}us max ${max}us",
+            ("name",name)("n",samples.size())("ops",int64_t(samples.size()) * 1000000 / std::max<int64_t>(total,1))
+            ("p50",percentile(50))("p90",percentile(90))("p99",percentile(99))("max",samples.back()) );
+   }
+
+   string          name;
+   vector<int64_t> samples;
+   int64_t         total = 0;
+};
+
+}
+
+/**
+ * Synthetic order book workloads for the market engine.
+ *
+ * Every market is a bitasset backed by CORE with @ref borrowers call orders of increasing collateral ratio,
+ * and @ref resting_orders limit orders on both sides of the book. The workloads run one after the other
+ * on the same books, so that each of them starts from a realistic state.
+ */
+BOOST_FIXTURE_TEST_SUITE( market_benchmarks, database_fixture )
+
+BOOST_AUTO_TEST_CASE( market_workload_benchmark )
+{ try {
+   const uint32_t markets = 10;
+   const uint32_t borrowers = 100;
+   const uint32_t resting_orders = 500;  // per side and market
+   const uint32_t takers = 2000;
+   const uint32_t cancels = 2000;
+   const uint32_t feed_steps = 20;
+   const uint32_t settlements = 500;
+   const uint32_t expiring_orders = 2000;
+
+   // matching rules after core-1270
+   auto mi = db.get_global_properties().parameters.maintenance_interval;
+   generate_blocks( HARDFORK_CORE_1270_TIME - mi );
+   generate_blocks( db.get_dynamic_global_properties().next_maintenance_time );
+
+   ACTORS( (trader)(feeder) );
+
+   signed_transaction tx;
+   uint32_t unconfirmed = 0;
+   auto push = [&]( const operation& op ) -> processed_transaction
+   {
+      tx.clear();
+      set_expiration( db, tx );
+      tx.operations.push_back( op );
+      for( auto& o : tx.operations )
+         db.current_fee_schedule().set_fee( o );
+      processed_transaction result = db.push_transaction( tx, ~0 );
+      if( ++unconfirmed >= 1000 )
+      {
+         generate_block();
+         unconfirmed = 0;
+      }
+      return result;
+   };
+   auto timed_push = [&]( const operation& op, latency_stats& stats ) -> processed_transaction
+   {
+      tx.clear();
+      set_expiration( db, tx );
+      tx.operations.push_back( op );
+      for( auto& o : tx.operations )
+         db.current_fee_schedule().set_fee( o );
+      auto start = fc::time_point::now();
+      processed_transaction result = db.push_transaction( tx, ~0 );
+      stats.add( fc::time_point::now() - start );
+      if( ++unconfirmed >= 1000 )
+      {
+         generate_block();
+         unconfirmed = 0;
+      }
+      return result;
+   };
+   auto flush = [&]()
+   {
+      generate_block();
+      unconfirmed = 0;
+   };
+
+   transfer_operation funding;
+   funding.from = committee_account;
+   funding.to = trader_id;
+   funding.amount = asset( int64_t(markets) * 1000000000 );
+   push( funding );
+   funding.to = feeder_id;
+   funding.amount = asset( 100000000 );
+   push( funding );
+   vector<account_id_type> borrower_ids;
+   for( uint32_t b = 0; b < borrowers; ++b )
+   {
+      borrower_ids.push_back( create_account( "borrower" + fc::to_string(b) ).id );
+      funding.to = borrower_ids.back();
+      funding.amount = asset( int64_t(markets) * 200000 + 10000000 );
+      push( funding );
+   }
+   flush();
+
+   // markets, feeds of 5 CORE per USD
+   vector<asset_id_type> usd;
+   auto feed_at = [&]( asset_id_type mia, int64_t core_per_ten_usd ) -> asset_publish_feed_operation
+   {
+      asset_publish_feed_operation op;
+      op.publisher = feeder_id;
+      op.asset_id = mia;
+      op.feed.maintenance_collateral_ratio = 1750;
+      op.feed.maximum_short_squeeze_ratio = 1100;
+      op.feed.settlement_price = asset( 10, mia ) / asset( core_per_ten_usd );
+      op.feed.core_exchange_rate = op.feed.settlement_price;
+      return op;
+   };
+   for( uint32_t m = 0; m < markets; ++m )
+   {
+      asset_create_operation create;
+      create.issuer = feeder_id;
+      create.symbol = "BENCHUSD" + fc::to_string(m);
+      create.precision = 4;
+      create.common_options.max_supply = GRAPHENE_MAX_SHARE_SUPPLY;
+      create.common_options.market_fee_percent = 0;
+      create.common_options.issuer_permissions = 0;
+      create.common_options.flags = 0;
+      create.common_options.core_exchange_rate = price( asset( 1, asset_id_type(1) ), asset( 1 ) );
+      create.bitasset_opts = bitasset_options();
+      create.bitasset_opts->force_settlement_delay_sec = 60;
+      usd.push_back( push( create ).operation_results[0].get<object_id_type>() );
+
+      asset_update_feed_producers_operation producers;
+      producers.issuer = feeder_id;
+      producers.asset_to_update = usd.back();
+      producers.new_feed_producers = { feeder_id };
+      push( producers );
+      push( feed_at( usd.back(), 50 ) );
+   }
+   flush();
+
+   // call orders, collateral ratios from 1.8 upwards at the initial feed
+   for( uint32_t m = 0; m < markets; ++m )
+   {
+      call_order_update_operation borrow;
+      borrow.delta_debt = asset( 10000, usd[m] );
+      for( uint32_t b = 0; b < borrowers; ++b )
+      {
+         borrow.funding_account = borrower_ids[b];
+         borrow.delta_collateral = asset( 90000 + 900 * b );
+         push( borrow );
+      }
+      // the trader borrows well collateralized to provide the asks
+      borrow.funding_account = trader_id;
+      borrow.delta_debt = asset( 10000000, usd[m] );
+      borrow.delta_collateral = asset( 500000000 );
+      push( borrow );
+   }
+   flush();
+
+   // resting asks between 5.6 and 7.6 CORE per USD, bids between 2.0 and 4.0 CORE per USD
+   map< asset_id_type, vector<limit_order_id_type> > bids;
+   limit_order_create_operation order;
+   order.seller = trader_id;
+   for( uint32_t m = 0; m < markets; ++m )
+   {
+      for( uint32_t j = 0; j < resting_orders; ++j )
+      {
+         order.amount_to_sell = asset( 1000, usd[m] );
+         order.min_to_receive = asset( 5600 + 4 * j );
+         push( order );
+         order.amount_to_sell = asset( 2000 + 4 * j );
+         order.min_to_receive = asset( 1000, usd[m] );
+         bids[usd[m]].push_back( push( order ).operation_results[0].get<object_id_type>() );
+      }
+   }
+   flush();
+
+   // crossing limit orders, each fills half of the best bid
+   latency_stats taker_stats( "Crossing limit orders" );
+   for( uint32_t i = 0; i < takers; ++i )
+   {
+      order.amount_to_sell = asset( 500, usd[i % markets] );
+      order.min_to_receive = asset( 500 );
+      timed_push( order, taker_stats );
+   }
+   flush();
+   taker_stats.report();
+
+   // cancel the worst bids, the takers only consumed the best ones
+   latency_stats cancel_stats( "Limit order cancellations" );
+   limit_order_cancel_operation cancel;
+   cancel.fee_paying_account = trader_id;
+   for( uint32_t i = 0; i < cancels; ++i )
+   {
+      cancel.order = bids[usd[i % markets]][i / markets];
+      timed_push( cancel, cancel_stats );
+   }
+   flush();
+   cancel_stats.report();
+
+   // raise the feeds step by step up to 7 CORE per USD, more call orders get margin called with every step
+   latency_stats feed_stats( "Feed updates with margin calls" );
+   for( uint32_t step = 1; step <= feed_steps; ++step )
+      for( uint32_t m = 0; m < markets; ++m )
+         timed_push( feed_at( usd[m], 50 + step ), feed_stats );
+   flush();
+   feed_stats.report();
+   ilog( "${n} call orders left after margin calls",
+         ("n",db.get_index_type<call_order_index>().indices().size()) );
+
+   // force settlements, executed by the block after the settlement delay
+   latency_stats settle_stats( "Force settlement requests" );
+   asset_settle_operation settle;
+   settle.account = trader_id;
+   for( uint32_t i = 0; i < settlements; ++i )
+   {
+      settle.amount = asset( 100, usd[i % markets] );
+      timed_push( settle, settle_stats );
+   }
+   flush();
+   settle_stats.report();
+
+   auto start = fc::time_point::now();
+   generate_blocks( db.head_block_time() + 60 );
+   generate_block();
+   auto elapsed = fc::time_point::now() - start;
+   wlog( "Executed force settlements in ${ms}ms, ${left} of ${n} still pending",
+         ("ms",elapsed.count()/1000)("n",settlements)
+         ("left",db.get_index_type<force_settlement_index>().indices().size()) );
+
+   // limit orders expiring in the same block
+   latency_stats expiring_stats( "Limit orders with expiration" );
+   order.expiration = db.head_block_time() + 120;
+   for( uint32_t i = 0; i < expiring_orders; ++i )
+   {
+      order.amount_to_sell = asset( 1500 + i % 100 );
+      order.min_to_receive = asset( 1000, usd[i % markets] );
+      timed_push( order, expiring_stats );
+   }
+   flush();
+   expiring_stats.report();
+
+   const size_t orders_before = db.get_index_type<limit_order_index>().indices().size();
+   start = fc::time_point::now();
+   generate_blocks( order.expiration );
+   generate_block();
+   elapsed = fc::time_point::now() - start;
+   wlog( "Expired ${n} limit orders in ${ms}ms",
+         ("n",orders_before - db.get_index_type<limit_order_index>().indices().size())("ms",elapsed.count()/1000) );
+
+} FC_LOG_AND_RETHROW() }
+
+/**
+ * Buyback accounts of many assets, only some of them find sellers. Measures the maintenance block that places the
+ * buyback orders, before and after the unfillable buyback hardfork.
+ */
+BOOST_AUTO_TEST_CASE( buyback_benchmark )
+{ try {
+   const uint32_t assets = 1000;
+   const uint32_t assets_with_sellers = 100;
+
+   ACTORS( (issuer)(seller) );
+   upgrade_to_lifetime_member( issuer_id );
+
+   signed_transaction tx;
+   auto push = [&]( const operation& op ) -> processed_transaction
+   {
+      tx.clear();
+      set_expiration( db, tx );
+      tx.operations.push_back( op );
+      for( auto& o : tx.operations )
+         db.current_fee_schedule().set_fee( o );
+      return db.push_transaction( tx, ~0 );
+   };
+
+   vector<asset_id_type> buyback_assets;
+   vector<account_id_type> buyback_accounts;
+   for( uint32_t i = 0; i < assets; ++i )
+   {
+      asset_create_operation create;
+      create.issuer = issuer_id;
+      create.symbol = "BUYBACK" + fc::to_string(i);
+      create.precision = 0;
+      create.common_options.max_supply = GRAPHENE_MAX_SHARE_SUPPLY;
+      create.common_options.issuer_permissions = 0;
+      create.common_options.flags = 0;
+      create.common_options.core_exchange_rate = price( asset( 1, asset_id_type(1) ), asset( 1 ) );
+      buyback_assets.push_back( push( create ).operation_results[0].get<object_id_type>() );
+
+      buyback_account_options bbo;
+      bbo.asset_to_buy = buyback_assets.back();
+      bbo.asset_to_buy_issuer = issuer_id;
+      bbo.markets.emplace( asset_id_type() );
+      account_create_operation account = make_account( "rex" + fc::to_string(i) );
+      account.registrar = issuer_id;
+      account.extensions.value.buyback_options = bbo;
+      account.owner = authority::null_authority();
+      account.active = authority::null_authority();
+      buyback_accounts.push_back( push( account ).operation_results[0].get<object_id_type>() );
+
+      if( i % 200 == 199 )
+         generate_block();
+   }
+   generate_block();
+
+   // each round funds all buyback accounts and lets the sellers offer some of their assets
+   auto prepare_round = [&]()
+   {
+      transfer_operation funding;
+      funding.from = committee_account;
+      for( const account_id_type& rex : buyback_accounts )
+      {
+         funding.to = rex;
+         funding.amount = asset( 1000 );
+         push( funding );
+      }
+      for( uint32_t i = 0; i < assets_with_sellers; ++i )
+      {
+         asset_issue_operation issue;
+         issue.issuer = issuer_id;
+         issue.asset_to_issue = asset( 100, buyback_assets[i] );
+         issue.issue_to_account = seller_id;
+         push( issue );
+
+         limit_order_create_operation order;
+         order.seller = seller_id;
+         order.amount_to_sell = asset( 100, buyback_assets[i] );
+         order.min_to_receive = asset( 500 );
+         push( order );
+      }
+      generate_block();
+   };
+   auto maintenance = [&]( const string& label )
+   {
+      const uint32_t interval = db.get_global_properties().parameters.block_interval;
+      generate_blocks( db.get_dynamic_global_properties().next_maintenance_time - interval );
+      const object_id_type next_order_id = db.get_index_type<limit_order_index>().get_next_id();
+      auto start = fc::time_point::now();
+      generate_block();
+      wlog( "${label}: maintenance block with ${n} buyback accounts took ${ms}ms, ${o} orders created",
+            ("label",label)("n",assets)("ms",( fc::time_point::now() - start ).count() / 1000)
+            ("o",db.get_index_type<limit_order_index>().get_next_id().instance() - next_order_id.instance()) );
+   };
+
+   prepare_round();
+   maintenance( "Before the unfillable buyback hardfork" );
+
+   generate_blocks( HARDFORK_CORE_UNFILLABLE_BUYBACK_TIME );
+   generate_block();
+   prepare_round();
+   maintenance( "After the unfillable buyback hardfork" );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( grouped_orders_benchmark )
+{ try {
+   const uint32_t order_count = 1000000;
+   graphene::app::orders_api orders_api(app);
+
+   ACTORS( (seller) );
+   const asset_id_type usd_id = create_user_issued_asset( "USD" ).id;
+   const std::string core_str = std::string( static_cast<object_id_type>(asset_id_type()) );
+   const std::string usd_str = std::string( static_cast<object_id_type>(usd_id) );
+
+   // orders are created directly in the object database, they spread over prices from 1 to 2 CORE per USD
+   vector<limit_order_id_type> order_ids;
+   order_ids.reserve( order_count );
+   auto start = fc::time_point::now();
+   for( uint32_t i = 0; i < order_count; ++i )
+   {
+      order_ids.push_back( db.create<limit_order_object>( [&]( limit_order_object& o ) {
+         o.seller = seller_id;
+         o.for_sale = 1000 + i % 1000;
+         o.sell_price = asset( 2000 ) / asset( int64_t( 1000 + ( uint64_t(i) * 7919 ) % 1000 ), usd_id );
+         o.expiration = time_point_sec::maximum();
+      }).id );
+   }
+   auto elapsed = fc::time_point::now() - start;
+   wlog( "Inserted ${n} limit orders in ${ms}ms", ("n",order_count)("ms",elapsed.count()/1000) );
+
+   start = fc::time_point::now();
+   vector< graphene::app::limit_order_group > groups;
+   for( uint32_t i = 0; i < 1000; ++i )
+      groups = orders_api.get_grouped_limit_orders( core_str, usd_str, 10, {}, 100 );
+   elapsed = fc::time_point::now() - start;
+   wlog( "Queried 1000 times 100 order groups in ${ms}ms", ("ms",elapsed.count()/1000) );
+   BOOST_CHECK_EQUAL( groups.size(), 100u );
+
+   start = fc::time_point::now();
+   for( const limit_order_id_type& id : order_ids )
+      db.modify( id(db), []( limit_order_object& o ) {
+         o.for_sale -= 1;
+      });
+   elapsed = fc::time_point::now() - start;
+   wlog( "Modified ${n} limit orders in ${ms}ms", ("n",order_count)("ms",elapsed.count()/1000) );
+
+   share_type total_for_sale = 0;
+   for( const graphene::app::limit_order_group& g : orders_api.get_grouped_limit_orders( core_str, usd_str, 100, {}, 100 ) )
+      total_for_sale += g.total_for_sale;
+   // 1000 * ( 999 + 1998 ) / 2 for every 1000 orders
+   BOOST_CHECK_EQUAL( total_for_sale.value, int64_t(order_count) / 1000 * 1498500 );
+
+   start = fc::time_point::now();
+   for( const limit_order_id_type& id : order_ids )
+      db.remove( id(db) );
+   elapsed = fc::time_point::now() - start;
+   wlog( "Removed ${n} limit orders in ${ms}ms", ("n",order_count)("ms",elapsed.count()/1000) );
+   BOOST_CHECK( orders_api.get_grouped_limit_orders( core_str, usd_str, 10, {}, 100 ).empty() );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
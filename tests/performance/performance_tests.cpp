@@ -27,6 +27,7 @@
 
 #include <graphene/chain/account_object.hpp>
 #include <graphene/chain/asset_object.hpp>
+#include <graphene/chain/market_object.hpp>
 #include <graphene/chain/proposal_object.hpp>
 
 #include <graphene/db/simple_index.hpp>
@@ -55,6 +56,199 @@ BOOST_AUTO_TEST_CASE( sigcheck_benchmark )
    wlog( "Benchmark: verify ${sps} signatures/s", ("sps",(cycles*1000000)/elapsed.count()) );
 }
 
+BOOST_AUTO_TEST_CASE( transaction_digest_benchmark )
+{
+   const fc::ecc::private_key nathan_key = fc::ecc::private_key::generate();
+   const uint64_t cycles = 1000;
+   const uint32_t trx_per_block = 1000;
+
+   signed_block block;
+   {
+      transfer_operation op;
+      op.amount = asset( 1 );
+      signed_transaction strx;
+      test::set_expiration( db, strx );
+      for( uint32_t i = 0; i < trx_per_block; ++i )
+      {
+         op.amount.amount = i + 1;
+         strx.clear();
+         strx.operations.push_back( op );
+         strx.sign( nathan_key, db.get_chain_id() );
+         block.transactions.push_back( processed_transaction( strx ) );
+         block.transactions.back().operation_results.push_back( void_result() );
+      }
+   }
+
+   // Serialization work done for a received block: transaction IDs, block size check and merkle root.
+   // Caches are dropped before each round so both variants start from scratch.
+   auto start = fc::time_point::now();
+   for( uint32_t i = 0; i < cycles; ++i )
+   {
+      signed_block b = block;
+      for( auto& trx : b.transactions )
+         trx.invalidate_cache();
+      for( const auto& trx : b.transactions )
+      {
+         digest_type::hash( static_cast<const transaction&>( trx ) );
+         fc::raw::pack_size( static_cast<const transaction&>( trx ) );
+      }
+      fc::raw::pack_size( b );
+      for( const auto& trx : b.transactions )
+         digest_type::hash( trx );
+   }
+   auto elapsed = fc::time_point::now() - start;
+   wlog( "Repeated serialization: ${us}us per block of ${n} transactions",
+         ("us",elapsed.count()/cycles)("n",trx_per_block) );
+
+   start = fc::time_point::now();
+   for( uint32_t i = 0; i < cycles; ++i )
+   {
+      signed_block b = block;
+      for( auto& trx : b.transactions )
+         trx.invalidate_cache();
+      for( const auto& trx : b.transactions )
+      {
+         trx.id();
+         trx.get_packed_size();
+      }
+      b.get_packed_size();
+      b.calculate_merkle_root();
+   }
+   elapsed = fc::time_point::now() - start;
+   wlog( "Cached serialization: ${us}us per block of ${n} transactions",
+         ("us",elapsed.count()/cycles)("n",trx_per_block) );
+}
+
+BOOST_AUTO_TEST_CASE( pending_transactions_benchmark )
+{ try {
+   ACTORS( (alice)(bob) );
+
+   const uint32_t pending_count = 10000;
+   const uint32_t blocks = 5;
+
+   transfer_operation to;
+   to.from = alice_id;
+   to.to = bob_id;
+   to.amount = asset( 1 );
+   to.fee = db.current_fee_schedule().calculate_fee( to );
+   fund( alice, asset( pending_count * ( pending_count + to.fee.amount.value ) ) );
+
+   // Fill the pending queue with transactions which stay valid for the next blocks
+   auto start = fc::time_point::now();
+   for( uint32_t i = 0; i < pending_count; ++i )
+   {
+      to.amount.amount = i + 1;
+      signed_transaction strx;
+      set_expiration( db, strx );
+      strx.operations.push_back( to );
+      sign( strx, alice_private_key );
+      db.push_transaction( strx, database::skip_nothing );
+   }
+   auto elapsed = fc::time_point::now() - start;
+   wlog( "Pushed ${n} pending transactions in ${ms}ms", ("n",pending_count)("ms",elapsed.count()/1000) );
+
+   // Push empty blocks produced elsewhere, every pending transaction is re-applied after each of them
+   start = fc::time_point::now();
+   for( uint32_t i = 0; i < blocks; ++i )
+   {
+      signed_block b;
+      b.previous = db.head_block_id();
+      b.timestamp = db.get_slot_time( 1 );
+      b.witness = db.get_scheduled_witness( 1 );
+      b.transaction_merkle_root = b.calculate_merkle_root();
+      b.sign( init_account_priv_key );
+      PUSH_BLOCK( db, b, database::skip_nothing );
+   }
+   elapsed = fc::time_point::now() - start;
+   wlog( "Re-applied ${n} pending transactions in ${us}us per block",
+         ("n",pending_count)("us",elapsed.count()/blocks) );
+
+   // All pending transactions are still applied
+   BOOST_CHECK_EQUAL( get_balance( bob_id, asset_id_type() ), int64_t(pending_count) * (pending_count + 1) / 2 );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( limit_order_benchmark )
+{ try {
+   ACTORS( (alice) );
+
+   const uint32_t markets = 20;
+   const uint32_t order_count = 100000;
+
+   vector<asset_id_type> assets;
+   for( uint32_t i = 0; i < markets; ++i )
+      assets.push_back( create_user_issued_asset( "MARKET" + fc::to_string(i) ).id );
+
+   limit_order_create_operation create_op;
+   create_op.seller = alice_id;
+   create_op.amount_to_sell = asset( 1000 );
+   create_op.min_to_receive = asset( 1000, assets[0] );
+   create_op.fee = db.current_fee_schedule().calculate_fee( create_op );
+   limit_order_cancel_operation cancel_op;
+   cancel_op.fee_paying_account = alice_id;
+   cancel_op.fee = db.current_fee_schedule().calculate_fee( cancel_op );
+   fund( alice, asset( int64_t(order_count) * ( 1000 + create_op.fee.amount.value + cancel_op.fee.amount.value ) ) );
+   generate_block();
+
+   db._undo_db.disable();
+
+   // Only core is sold, so no order matches and every market side fills up with many different prices
+   signed_transaction tx;
+   set_expiration( db, tx );
+   vector<limit_order_id_type> orders;
+   orders.reserve( order_count );
+   auto start = fc::time_point::now();
+   for( uint32_t i = 0; i < order_count; ++i )
+   {
+      create_op.amount_to_sell.amount = 1 + ( int64_t(i) * 7919 ) % 1000;
+      create_op.min_to_receive = asset( 1 + ( int64_t(i) * 104729 ) % 100000, assets[i % markets] );
+      tx.operations.clear();
+      tx.operations.push_back( create_op );
+      auto result = db.apply_transaction( tx, ~0 );
+      orders.push_back( result.operation_results[0].get<object_id_type>() );
+   }
+   auto elapsed = fc::time_point::now() - start;
+   wlog( "${n} limit order creations/s over ${ms}ms",
+         ("n",(uint64_t(order_count)*1000000)/elapsed.count())("ms",elapsed.count()/1000) );
+
+   // Cancel in a different order than creation to hit all positions of the books
+   start = fc::time_point::now();
+   for( uint32_t i = 0; i < order_count; ++i )
+   {
+      cancel_op.order = orders[( uint64_t(i) * 7919 ) % order_count];
+      tx.operations.clear();
+      tx.operations.push_back( cancel_op );
+      db.apply_transaction( tx, ~0 );
+   }
+   elapsed = fc::time_point::now() - start;
+   wlog( "${n} limit order cancellations/s over ${ms}ms",
+         ("n",(uint64_t(order_count)*1000000)/elapsed.count())("ms",elapsed.count()/1000) );
+
+   BOOST_CHECK( db.get_index_type<limit_order_index>().indices().empty() );
+
+   db._undo_db.enable();
+
+   // Compare sorting by price with sorting by the precomputed price keys
+   vector<price> prices;
+   prices.reserve( order_count );
+   for( uint32_t i = 0; i < order_count; ++i )
+      prices.push_back( asset( 1 + ( int64_t(i) * 7919 ) % 1000 )
+                        / asset( 1 + ( int64_t(i) * 104729 ) % 100000, assets[i % markets] ) );
+   vector<price_key> keys( prices.begin(), prices.end() );
+
+   start = fc::time_point::now();
+   std::sort( prices.begin(), prices.end(), std::greater<price>() );
+   elapsed = fc::time_point::now() - start;
+   wlog( "Sorted ${n} prices in ${ms}ms", ("n",order_count)("ms",elapsed.count()/1000) );
+
+   start = fc::time_point::now();
+   std::sort( keys.begin(), keys.end(), std::greater<price_key>() );
+   elapsed = fc::time_point::now() - start;
+   wlog( "Sorted ${n} price keys in ${ms}ms", ("n",order_count)("ms",elapsed.count()/1000) );
+
+   for( uint32_t i = 0; i < order_count; ++i )
+      BOOST_CHECK( keys[i].value == prices[i] );
+} FC_LOG_AND_RETHROW() }
+
 // See https://bitshares.org/blog/2015/06/08/measuring-performance/
 // (note this is not the original test mentioned in the above post, but was
 //  recreated later according to the description)
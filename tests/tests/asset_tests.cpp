@@ -25,7 +25,12 @@
 #include <boost/test/unit_test.hpp>
 #include <string>
 #include <cmath>
+#include <limits>
+#include <random>
 #include <graphene/chain/asset_object.hpp>
+#include <graphene/protocol/fixed_point.hpp>
+
+#include <fc/uint128.hpp>
 
 BOOST_AUTO_TEST_SUITE(asset_tests)
 
@@ -72,4 +77,100 @@ BOOST_AUTO_TEST_CASE( asset_to_from_string )
    }
 }
 
+namespace {
+
+/// The arithmetic the fixed-point helpers replaced
+bool reference_multiply_and_divide( int64_t a, int64_t b, int64_t c, bool round_up, int64_t& result )
+{
+   fc::uint128_t r = fc::uint128_t( a ) * b;
+   if( round_up )
+      r += c - 1;
+   r /= c;
+   if( r > GRAPHENE_MAX_SHARE_SUPPLY )
+      return false;
+   result = static_cast<int64_t>(r);
+   return true;
+}
+
+void check_multiply_and_divide( int64_t a, int64_t b, int64_t c )
+{
+   int64_t expected = -1;
+   int64_t actual = -1;
+   bool expected_ok = reference_multiply_and_divide( a, b, c, false, expected );
+   bool actual_ok = graphene::protocol::fixed_point::multiply_and_divide( a, b, c, actual );
+   BOOST_REQUIRE_MESSAGE( expected_ok == actual_ok && ( !expected_ok || expected == actual ),
+                          "floor( " << a << " * " << b << " / " << c << " )" );
+
+   expected_ok = reference_multiply_and_divide( a, b, c, true, expected );
+   actual_ok = graphene::protocol::fixed_point::multiply_and_divide_round_up( a, b, c, actual );
+   BOOST_REQUIRE_MESSAGE( expected_ok == actual_ok && ( !expected_ok || expected == actual ),
+                          "ceil( " << a << " * " << b << " / " << c << " )" );
+}
+
+void check_percent_of( int64_t value, uint16_t percent )
+{
+   int64_t expected = -1;
+   int64_t actual = -1;
+   bool expected_ok = reference_multiply_and_divide( value, percent, GRAPHENE_100_PERCENT, false, expected );
+   bool actual_ok = graphene::protocol::fixed_point::percent_of( value, percent, actual );
+   BOOST_REQUIRE_MESSAGE( expected_ok == actual_ok && ( !expected_ok || expected == actual ),
+                          value << " * " << percent << " / 100%" );
+}
+
+}
+
+BOOST_AUTO_TEST_CASE( fixed_point_equivalence )
+{
+   const std::vector<int64_t> edges = { 0, 1, 2, 3, 7, 9999, 10000, 10001,
+                                        (1ll << 31) - 1, 1ll << 31, (1ll << 32) - 1, 1ll << 32, (1ll << 32) + 1,
+                                        (1ll << 48) - 1, 1ll << 48, (1ll << 48) + 1,
+                                        GRAPHENE_MAX_SHARE_SUPPLY - 1, GRAPHENE_MAX_SHARE_SUPPLY,
+                                        GRAPHENE_MAX_SHARE_SUPPLY + 1, std::numeric_limits<int64_t>::max() };
+
+   for( int64_t a : edges )
+      for( int64_t b : edges )
+         for( int64_t c : edges )
+            if( c > 0 )
+               check_multiply_and_divide( a, b, c );
+
+   for( int64_t value : edges )
+      for( uint16_t percent : { 0, 1, 2, 50, 100, 9999, 10000, 10001, 65535 } )
+         check_percent_of( value, percent );
+
+   // random operands of random bit widths
+   std::mt19937_64 gen( 2019 );
+   auto random_amount = [&gen]() {
+      return int64_t( gen() >> ( 1 + gen() % 63 ) );
+   };
+   for( uint32_t i = 0; i < 1000000; ++i )
+   {
+      check_multiply_and_divide( random_amount(), random_amount(), std::max<int64_t>( random_amount(), 1 ) );
+      check_percent_of( random_amount(), uint16_t( gen() ) );
+   }
+}
+
+BOOST_AUTO_TEST_CASE( asset_times_price_rounding )
+{
+   using graphene::protocol::asset;
+   using graphene::protocol::asset_id_type;
+   const asset_id_type usd_id( 1 );
+
+   const auto p = asset( 3 ) / asset( 7, usd_id );
+   BOOST_CHECK( asset( 10 ) * p == asset( 23, usd_id ) );
+   BOOST_CHECK( asset( 10 ).multiply_and_round_up( p ) == asset( 24, usd_id ) );
+   BOOST_CHECK( asset( 10, usd_id ) * p == asset( 4 ) );
+   BOOST_CHECK( asset( 10, usd_id ).multiply_and_round_up( p ) == asset( 5 ) );
+   BOOST_CHECK( asset( 21, usd_id ).multiply_and_round_up( p ) == asset( 9 ) );
+
+   // operands beyond 32 bits
+   const auto big = asset( GRAPHENE_MAX_SHARE_SUPPLY ) / asset( GRAPHENE_MAX_SHARE_SUPPLY - 1, usd_id );
+   BOOST_CHECK( asset( GRAPHENE_MAX_SHARE_SUPPLY ) * big == asset( GRAPHENE_MAX_SHARE_SUPPLY - 1, usd_id ) );
+   BOOST_CHECK( asset( GRAPHENE_MAX_SHARE_SUPPLY - 1, usd_id ) * big == asset( GRAPHENE_MAX_SHARE_SUPPLY ) );
+   BOOST_CHECK( asset( GRAPHENE_MAX_SHARE_SUPPLY - 2, usd_id ) * big == asset( GRAPHENE_MAX_SHARE_SUPPLY - 2 ) );
+   BOOST_CHECK( asset( GRAPHENE_MAX_SHARE_SUPPLY - 2, usd_id ).multiply_and_round_up( big )
+                == asset( GRAPHENE_MAX_SHARE_SUPPLY - 1 ) );
+   BOOST_CHECK_THROW( asset( GRAPHENE_MAX_SHARE_SUPPLY, usd_id ) * big, fc::assert_exception );
+   BOOST_CHECK_THROW( asset( 1, asset_id_type( 2 ) ) * p, fc::assert_exception );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
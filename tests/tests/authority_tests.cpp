@@ -2183,6 +2183,175 @@ BOOST_AUTO_TEST_CASE( irrelevant_signatures )
    PUSH_TX( db, trx );
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE( authority_check_cache_test )
+{ try {
+   ACTORS( (alice)(bob) );
+   fund( alice );
+
+   auto get_active = [&]( account_id_type aid ) -> const authority* { return &(aid(db).active); };
+   auto get_owner  = [&]( account_id_type aid ) -> const authority* { return &(aid(db).owner);  };
+   authority_check_cache cache( get_active, get_owner );
+
+   transfer_operation to;
+   to.amount = asset( 1 );
+   to.from = alice_id;
+   to.to = bob_id;
+
+   signed_transaction tx;
+   tx.operations.push_back( to );
+   GRAPHENE_REQUIRE_THROW( tx.verify_authority( db.get_chain_id(), cache, true ), tx_missing_active_auth );
+
+   sign( tx, alice_private_key );
+   // the second check is served from the cache
+   tx.verify_authority( db.get_chain_id(), cache, true );
+   tx.verify_authority( db.get_chain_id(), cache, true );
+   BOOST_CHECK( cache.find_result( get_active( alice_id ), tx.get_signature_keys( db.get_chain_id() ) ) != nullptr );
+
+   signed_transaction tx2 = tx;
+   sign( tx2, bob_private_key );
+   GRAPHENE_REQUIRE_THROW( tx2.verify_authority( db.get_chain_id(), cache, true ), tx_irrelevant_sig );
+   GRAPHENE_REQUIRE_THROW( tx2.verify_authority( db.get_chain_id(), cache, true ), tx_irrelevant_sig );
+
+   // cached results are outdated after alice changed her authorities
+   account_update_operation auo;
+   auo.account = alice_id;
+   auo.owner = authority( 1, bob_public_key, 1 );
+   auo.active = authority( 1, bob_public_key, 1 );
+   trx.clear();
+   set_expiration( db, trx );
+   trx.operations.push_back( auo );
+   sign( trx, alice_private_key );
+   PUSH_TX( db, trx );
+   trx.clear();
+
+   cache.invalidate( alice_id );
+   BOOST_CHECK( cache.find_result( get_active( alice_id ), tx.get_signature_keys( db.get_chain_id() ) ) == nullptr );
+   GRAPHENE_REQUIRE_THROW( tx.verify_authority( db.get_chain_id(), cache, true ), tx_missing_active_auth );
+
+   signed_transaction tx3;
+   tx3.operations.push_back( to );
+   sign( tx3, bob_private_key );
+   tx3.verify_authority( db.get_chain_id(), cache, true );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( authority_check_cache_block_test )
+{ try {
+   ACTORS( (alice)(bob) );
+   fund( alice );
+   generate_block();
+
+   auto make_transfer = [&]( int64_t amount ) {
+      transfer_operation to;
+      to.amount = asset( amount );
+      to.from = alice_id;
+      to.to = bob_id;
+      signed_transaction tx;
+      tx.operations.push_back( to );
+      set_expiration( db, tx );
+      sign( tx, alice_private_key );
+      return tx;
+   };
+
+   // the first transfer caches the check of the key of alice, the second one is signed with the same key after
+   // alice replaced it in the same block
+   account_update_operation auo;
+   auo.account = alice_id;
+   auo.active = authority( 1, bob_public_key, 1 );
+   signed_transaction update_tx;
+   update_tx.operations.push_back( auo );
+   set_expiration( db, update_tx );
+   sign( update_tx, alice_private_key );
+
+   PUSH_TX( db, make_transfer( 1 ), database::skip_transaction_signatures );
+   PUSH_TX( db, update_tx, database::skip_transaction_signatures );
+   PUSH_TX( db, make_transfer( 2 ), database::skip_transaction_signatures );
+   signed_block b = generate_block( database::skip_transaction_signatures );
+   BOOST_REQUIRE_EQUAL( b.transactions.size(), 3u );
+   db.pop_block();
+   const uint32_t head_num = db.head_block_num();
+
+   GRAPHENE_REQUIRE_THROW( PUSH_BLOCK( db, b, database::skip_nothing ), fc::exception );
+   // the transactions of the popped block were restored as pending transactions
+   db.clear_pending();
+   BOOST_CHECK_EQUAL( db.head_block_num(), head_num );
+   BOOST_CHECK( alice_id(db).active == authority( 1, alice_public_key, 1 ) );
+
+   // the block is valid without the last transfer
+   b.transactions.pop_back();
+   b.transaction_merkle_root = b.calculate_merkle_root();
+   b.sign( init_account_priv_key );
+   PUSH_BLOCK( db, b, database::skip_nothing );
+   BOOST_CHECK( alice_id(db).active == authority( 1, bob_public_key, 1 ) );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( authority_check_cache_proposal_test )
+{ try {
+   ACTORS( (alice)(bob) );
+   fund( alice );
+
+   // alice proposes to replace her key
+   account_update_operation auo;
+   auo.account = alice_id;
+   auo.active = authority( 1, bob_public_key, 1 );
+   proposal_create_operation pop;
+   pop.fee_paying_account = alice_id;
+   pop.expiration_time = db.head_block_time() + fc::days(1);
+   pop.proposed_ops.emplace_back( auo );
+   trx.clear();
+   set_expiration( db, trx );
+   trx.operations.push_back( pop );
+   sign( trx, alice_private_key );
+   const proposal_id_type pid = PUSH_TX( db, trx ).operation_results[0].get<object_id_type>();
+   trx.clear();
+   generate_block();
+
+   auto make_transfer = [&]( int64_t amount ) {
+      transfer_operation to;
+      to.amount = asset( amount );
+      to.from = alice_id;
+      to.to = bob_id;
+      signed_transaction tx;
+      tx.operations.push_back( to );
+      set_expiration( db, tx );
+      sign( tx, alice_private_key );
+      return tx;
+   };
+
+   // the approval of alice executes the proposal, the key of alice is replaced between the two transfers
+   proposal_update_operation pup;
+   pup.fee_paying_account = alice_id;
+   pup.proposal = pid;
+   pup.active_approvals_to_add.insert( alice_id );
+   signed_transaction approve_tx;
+   approve_tx.operations.push_back( pup );
+   set_expiration( db, approve_tx );
+   sign( approve_tx, alice_private_key );
+
+   PUSH_TX( db, make_transfer( 1 ), database::skip_transaction_signatures );
+   PUSH_TX( db, approve_tx, database::skip_transaction_signatures );
+   BOOST_REQUIRE( db.find( pid ) == nullptr );
+   PUSH_TX( db, make_transfer( 2 ), database::skip_transaction_signatures );
+   signed_block b = generate_block( database::skip_transaction_signatures );
+   BOOST_REQUIRE_EQUAL( b.transactions.size(), 3u );
+   db.pop_block();
+   const uint32_t head_num = db.head_block_num();
+
+   GRAPHENE_REQUIRE_THROW( PUSH_BLOCK( db, b, database::skip_nothing ), fc::exception );
+   // the transactions of the popped block were restored as pending transactions
+   db.clear_pending();
+   BOOST_CHECK_EQUAL( db.head_block_num(), head_num );
+   BOOST_CHECK( db.find( pid ) != nullptr );
+   BOOST_CHECK( alice_id(db).active == authority( 1, alice_public_key, 1 ) );
+
+   // the block is valid without the last transfer
+   b.transactions.pop_back();
+   b.transaction_merkle_root = b.calculate_merkle_root();
+   b.sign( init_account_priv_key );
+   PUSH_BLOCK( db, b, database::skip_nothing );
+   BOOST_CHECK( db.find( pid ) == nullptr );
+   BOOST_CHECK( alice_id(db).active == authority( 1, bob_public_key, 1 ) );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE( self_approving_proposal )
 { try {
    ACTORS( (alice) );
@@ -592,6 +592,45 @@ BOOST_AUTO_TEST_CASE( merkle_root )
    BOOST_CHECK( block.calculate_merkle_root() == c(dO) );
 }
 
+BOOST_AUTO_TEST_CASE( precomputable_transaction_cache )
+{
+   const auto key = fc::ecc::private_key::regenerate( fc::sha256::hash( std::string( "cache" ) ) );
+
+   signed_transaction strx;
+   strx.ref_block_num = 1;
+   strx.ref_block_prefix = 2;
+   strx.expiration = fc::time_point_sec( 3 );
+   transfer_operation op;
+   op.amount = asset( 100 );
+   strx.operations.push_back( op );
+   strx.sign( key, db.get_chain_id() );
+
+   processed_transaction ptrx( strx );
+   ptrx.operation_results.push_back( void_result() );
+
+   // cached values must be identical to freshly serialized ones
+   BOOST_CHECK( ptrx.digest() == strx.digest() );
+   BOOST_CHECK( ptrx.id() == strx.id() );
+   BOOST_CHECK_EQUAL( ptrx.get_packed_size(), strx.get_packed_size() );
+   BOOST_CHECK_EQUAL( ptrx.get_full_packed_size(), fc::raw::pack_size( ptrx ) );
+   BOOST_CHECK( ptrx.merkle_digest() == digest_type::hash( ptrx ) );
+   BOOST_CHECK( ptrx.get_signature_keys( db.get_chain_id() ).count( key.get_public_key() ) == 1 );
+
+   // after a modification and invalidating the cache, the values are computed again
+   const transaction_id_type old_id = ptrx.id();
+   ptrx.ref_block_num = 5;
+   ptrx.invalidate_cache();
+   strx.ref_block_num = 5;
+   BOOST_CHECK( ptrx.id() != old_id );
+   BOOST_CHECK( ptrx.id() == strx.id() );
+   BOOST_CHECK( ptrx.merkle_digest() == digest_type::hash( ptrx ) );
+
+   signed_block block;
+   block.transactions.push_back( ptrx );
+   block.transactions.push_back( ptrx );
+   BOOST_CHECK_EQUAL( block.get_packed_size(), fc::raw::pack_size( block ) );
+}
+
 /**
  * Reproduces https://github.com/bitshares/bitshares-core/issues/888 and tests fix for it.
  */
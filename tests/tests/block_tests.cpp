@@ -32,6 +32,7 @@
 #include <graphene/chain/committee_member_object.hpp>
 #include <graphene/chain/proposal_object.hpp>
 #include <graphene/chain/market_object.hpp>
+#include <graphene/chain/withdraw_permission_object.hpp>
 #include <graphene/chain/hardfork.hpp>
 #include <graphene/chain/witness_schedule_object.hpp>
 #include <graphene/chain/witness_object.hpp>
@@ -1935,4 +1936,290 @@ BOOST_FIXTURE_TEST_CASE( block_size_test, database_fixture )
    }
 }
 
+BOOST_FIXTURE_TEST_CASE( block_assembly_strategy_test, database_fixture )
+{ try {
+   ACTORS( (alice)(bob) );
+   fund( alice );
+   fund( bob );
+
+   auto make_transfer = [&]( account_id_type from, account_id_type to, int64_t amount, bool with_memo ) {
+      transfer_operation xfer_op;
+      xfer_op.from = from;
+      xfer_op.to = to;
+      xfer_op.amount = asset( amount );
+      if( with_memo )
+      {
+         xfer_op.memo = memo_data();
+         xfer_op.memo->message = vector<char>( 100, 'x' );
+      }
+      xfer_op.fee = db.current_fee_schedule().calculate_fee( xfer_op );
+      signed_transaction xfer_tx;
+      xfer_tx.operations.push_back( xfer_op );
+      set_expiration( db, xfer_tx );
+      return xfer_tx;
+   };
+
+   // The memo makes the first transaction of Alice pay less per byte than the others,
+   // but her second transaction must still not be included before her first one
+   signed_transaction tx1 = make_transfer( alice_id, bob_id, 1, true );
+   signed_transaction tx2 = make_transfer( alice_id, bob_id, 2, false );
+   signed_transaction tx3 = make_transfer( bob_id, alice_id, 3, false );
+   sign( tx1, alice_private_key );
+   sign( tx2, alice_private_key );
+   sign( tx3, bob_private_key );
+
+   vector<processed_transaction> trxs = { processed_transaction( tx1 ), processed_transaction( tx2 ),
+                                          processed_transaction( tx3 ) };
+   const auto fee_of = []( const signed_transaction& tx ) {
+      return tx.operations.front().get<transfer_operation>().fee.amount.value;
+   };
+   BOOST_REQUIRE( fc::uint128_t( fee_of( tx3 ) ) * trxs[0].get_full_packed_size()
+                  > fc::uint128_t( fee_of( tx1 ) ) * trxs[2].get_full_packed_size() );
+
+   BOOST_CHECK( database::order_by_arrival( db, trxs ) == vector<size_t>( { 0, 1, 2 } ) );
+   BOOST_CHECK( database::order_by_fee_per_byte( db, trxs ) == vector<size_t>( { 2, 0, 1 } ) );
+
+   // A transaction with several fee payers waits for the earlier transactions of all of them
+   signed_transaction tx4 = make_transfer( bob_id, alice_id, 4, false );
+   tx4.operations.push_back( make_transfer( alice_id, bob_id, 5, false ).operations.front() );
+   trxs.push_back( processed_transaction( tx4 ) );
+   trxs.push_back( processed_transaction( make_transfer( bob_id, alice_id, 6, false ) ) );
+   BOOST_CHECK( database::order_by_fee_per_byte( db, trxs ) == vector<size_t>( { 2, 0, 1, 3, 4 } ) );
+   trxs.resize( 3 );
+
+   db.set_block_assembly_strategy( database::order_by_fee_per_byte, true );
+   PUSH_TX( db, tx1 );
+   PUSH_TX( db, tx2 );
+   PUSH_TX( db, tx3 );
+   signed_block b = db.generate_block( db.get_slot_time(1), db.get_scheduled_witness(1), init_account_priv_key,
+                                       database::skip_nothing );
+   BOOST_REQUIRE_EQUAL( b.transactions.size(), 3u );
+   BOOST_CHECK( b.transactions[0].id() == tx3.id() );
+   BOOST_CHECK( b.transactions[1].id() == tx1.id() );
+   BOOST_CHECK( b.transactions[2].id() == tx2.id() );
+
+   const auto& stats = db.get_last_block_assembly_stats();
+   BOOST_CHECK_EQUAL( stats.candidates, 3u );
+   BOOST_CHECK_EQUAL( stats.included, 3u );
+   BOOST_CHECK_EQUAL( stats.postponed_by_size, 0u );
+   BOOST_CHECK_EQUAL( stats.postponed_by_payer, 0u );
+   BOOST_CHECK_EQUAL( stats.failed, 0u );
+   BOOST_CHECK_GE( stats.block_size, fc::raw::pack_size( b ) );
+   BOOST_CHECK_LE( stats.block_size, stats.maximum_block_size );
+
+   // Leave room for two transfers without memo only. The first transaction of Alice does not fit, so her second
+   // one and the one paid by both Bob and Alice are postponed, which in turn postpones the last one of Bob.
+   size_t header_size = stats.block_size;
+   for( const processed_transaction& ptx : b.transactions )
+      header_size -= ptx.get_full_packed_size();
+   const size_t plain_size = b.transactions[0].get_full_packed_size();
+   BOOST_REQUIRE_GT( b.transactions[1].get_full_packed_size(), plain_size + 2 );
+   db._undo_db.disable();
+   db.modify( db.get_global_properties(), [header_size,plain_size]( global_property_object& p ) {
+      p.parameters.maximum_block_size = header_size + 2 * ( plain_size + 1 );
+   });
+   db._undo_db.enable();
+
+   signed_transaction tx5 = make_transfer( bob_id, alice_id, 5, false );
+   signed_transaction tx6 = make_transfer( alice_id, bob_id, 6, true );
+   signed_transaction tx7 = make_transfer( alice_id, bob_id, 7, false );
+   signed_transaction tx8 = make_transfer( bob_id, alice_id, 8, false );
+   tx8.operations.push_back( make_transfer( alice_id, bob_id, 9, false ).operations.front() );
+   signed_transaction tx9 = make_transfer( bob_id, alice_id, 10, false );
+   sign( tx5, bob_private_key );
+   sign( tx6, alice_private_key );
+   sign( tx7, alice_private_key );
+   sign( tx8, bob_private_key );
+   sign( tx8, alice_private_key );
+   sign( tx9, bob_private_key );
+   for( const signed_transaction* tx : { &tx5, &tx6, &tx7, &tx8, &tx9 } )
+      PUSH_TX( db, *tx );
+   b = db.generate_block( db.get_slot_time(1), db.get_scheduled_witness(1), init_account_priv_key,
+                          database::skip_nothing );
+   BOOST_REQUIRE_EQUAL( b.transactions.size(), 1u );
+   BOOST_CHECK( b.transactions[0].id() == tx5.id() );
+
+   BOOST_CHECK_EQUAL( stats.candidates, 5u );
+   BOOST_CHECK_EQUAL( stats.included, 1u );
+   BOOST_CHECK_EQUAL( stats.postponed_by_size, 1u );
+   BOOST_CHECK_EQUAL( stats.postponed_by_payer, 3u );
+   BOOST_CHECK_EQUAL( stats.failed, 0u );
+} FC_LOG_AND_RETHROW() }
+
+/**
+ * Regression test: replaying with undo history disabled has to expire withdraw permissions and proposals at the
+ * same blocks as the node which applied the blocks normally, and has to end in the same state.
+ */
+BOOST_FIXTURE_TEST_CASE( replay_expirations_test, database_fixture )
+{ try {
+   ACTORS( (alice)(bob) );
+   transfer( account_id_type(), alice_id, asset( 1000000 ) );
+   generate_block();
+
+   const auto block_interval = db.get_global_properties().parameters.block_interval;
+
+   signed_transaction trx;
+   set_expiration( db, trx );
+
+   withdraw_permission_create_operation wop;
+   wop.withdraw_from_account = alice_id;
+   wop.authorized_account = bob_id;
+   wop.withdrawal_limit = asset( 5 );
+   wop.withdrawal_period_sec = block_interval * 10;
+   wop.periods_until_expiration = 1;
+   wop.period_start_time = db.head_block_time() + block_interval;
+   trx.operations.push_back( wop );
+
+   transfer_operation top;
+   top.from = alice_id;
+   top.to = bob_id;
+   top.amount = asset( 100 );
+   proposal_create_operation pop;
+   pop.proposed_ops.emplace_back( top );
+   pop.expiration_time = db.head_block_time() + block_interval * 20;
+   pop.fee_paying_account = alice_id;
+   trx.operations.push_back( pop );
+
+   sign( trx, alice_private_key );
+   processed_transaction ptx = PUSH_TX( db, trx );
+   const withdraw_permission_id_type permit_id( ptx.operation_results[0].get<object_id_type>() );
+   const proposal_id_type proposal_id( ptx.operation_results[1].get<object_id_type>() );
+
+   // remember in which blocks the objects were still alive
+   map< uint32_t, std::pair<bool,bool> > alive;
+   for( int i = 0; i < 30; ++i )
+   {
+      generate_block();
+      alive[db.head_block_num()] = std::make_pair( db.find( permit_id ) != nullptr,
+                                                   db.find( proposal_id ) != nullptr );
+   }
+   BOOST_CHECK( db.find( permit_id ) == nullptr );
+   BOOST_CHECK( db.find( proposal_id ) == nullptr );
+
+   fc::temp_directory data_dir2( graphene::utilities::temp_directory_path() );
+   database db2;
+   db2.open( data_dir2.path(), make_genesis, "TEST" );
+   BOOST_CHECK( db.get_chain_id() == db2.get_chain_id() );
+
+   db2._undo_db.disable();
+   while( db2.head_block_num() < db.head_block_num() )
+   {
+      optional< signed_block > b = db.fetch_block_by_number( db2.head_block_num() + 1 );
+      db2.apply_block( *b, ~0 );
+      auto itr = alive.find( db2.head_block_num() );
+      if( itr != alive.end() )
+      {
+         BOOST_CHECK_EQUAL( db2.find( permit_id ) != nullptr, itr->second.first );
+         BOOST_CHECK_EQUAL( db2.find( proposal_id ) != nullptr, itr->second.second );
+      }
+   }
+   db2._undo_db.enable();
+
+   BOOST_CHECK( db2.head_block_id() == db.head_block_id() );
+   BOOST_CHECK_EQUAL( db2.get_balance( alice_id, asset_id_type() ).amount.value,
+                      db.get_balance( alice_id, asset_id_type() ).amount.value );
+   BOOST_CHECK_EQUAL( db2.get_balance( bob_id, asset_id_type() ).amount.value,
+                      db.get_balance( bob_id, asset_id_type() ).amount.value );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_FIXTURE_TEST_CASE( witness_schedule_cache_test, database_fixture )
+{ try {
+   const auto block_interval = db.get_global_properties().parameters.block_interval;
+
+   auto check_schedule = [this]() {
+      const witness_schedule_cache* schedule = db.get_witness_schedule_cache();
+      BOOST_REQUIRE( schedule != nullptr );
+      const auto& shuffled = db.get_witness_schedule_object().current_shuffled_witnesses;
+      const uint64_t aslot = db.get_dynamic_global_properties().current_aslot;
+      BOOST_CHECK( schedule->witnesses == shuffled );
+      for( uint32_t slot = 1; slot <= 2 * shuffled.size(); ++slot )
+      {
+         const witness_id_type expected = shuffled[ ( aslot + slot ) % shuffled.size() ];
+         BOOST_CHECK( db.get_scheduled_witness( slot ) == expected );
+         BOOST_CHECK( schedule->get_scheduled_signing_key( slot ) == expected(db).signing_key );
+         BOOST_CHECK_EQUAL( db.get_slot_at_time( db.get_slot_time( slot ) ), slot );
+      }
+      BOOST_CHECK_EQUAL( db.get_slot_at_time( db.head_block_time() ), 0u );
+   };
+
+   generate_block();
+   check_schedule();
+   BOOST_CHECK( db.get_slot_time( 1 ) == db.head_block_time() + block_interval );
+
+   // slots are skipped after a maintenance block
+   generate_blocks( db.get_dynamic_global_properties().next_maintenance_time );
+   check_schedule();
+   BOOST_CHECK( db.get_slot_time( 1 ) == db.head_block_time()
+                + block_interval * ( 1 + db.get_global_properties().parameters.maintenance_skip_slots ) );
+
+   generate_block();
+
+   // a new signing key is picked up after the block
+   const witness_id_type wit = db.get_scheduled_witness( 1 );
+   const public_key_type new_key = generate_private_key( "new signing key" ).get_public_key();
+   witness_update_operation wuop;
+   wuop.witness_account = wit(db).witness_account;
+   wuop.witness = wit;
+   wuop.new_signing_key = new_key;
+   trx.operations.push_back( wuop );
+   set_expiration( db, trx );
+   PUSH_TX( db, trx, ~0 );
+   trx.clear();
+   generate_block();
+   check_schedule();
+   BOOST_CHECK( wit(db).signing_key == new_key );
+
+   // the cache does not describe the state after a block was popped, lookups fall back to the objects
+   const fc::time_point_sec slot_time = db.get_slot_time( 1 );
+   db.pop_block();
+   BOOST_CHECK( db.get_witness_schedule_cache() == nullptr );
+   BOOST_CHECK( db.get_slot_time( 1 ) == db.head_block_time() + block_interval );
+   BOOST_CHECK( db.get_slot_time( 1 ) < slot_time );
+   generate_block();
+   check_schedule();
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_FIXTURE_TEST_CASE( hardfork_state_test, database_fixture )
+{ try {
+   hardfork_state state;
+   for( const fc::time_point_sec maint_time : { HARDFORK_CORE_184_TIME, HARDFORK_CORE_184_TIME + 1,
+                                                HARDFORK_CORE_1270_TIME, HARDFORK_CORE_1270_TIME + 1,
+                                                HARDFORK_CORE_UNFILLABLE_BUYBACK_TIME,
+                                                HARDFORK_CORE_UNFILLABLE_BUYBACK_TIME + 1 } )
+   {
+      state.update( maint_time );
+      BOOST_CHECK( state.next_maintenance_time() == maint_time );
+      BOOST_CHECK_EQUAL( state.passed( maintenance_hardfork::CORE_184 ), maint_time > HARDFORK_CORE_184_TIME );
+      BOOST_CHECK_EQUAL( state.passed( maintenance_hardfork::CORE_868_890 ),
+                         maint_time > HARDFORK_CORE_868_890_TIME );
+      BOOST_CHECK_EQUAL( state.passed( maintenance_hardfork::CORE_1270 ), maint_time > HARDFORK_CORE_1270_TIME );
+      BOOST_CHECK_EQUAL( state.before( maintenance_hardfork::CORE_1270 ), maint_time <= HARDFORK_CORE_1270_TIME );
+      BOOST_CHECK( !state.before<true>( maintenance_hardfork::CORE_1270 ) );
+      BOOST_CHECK_EQUAL( state.passed_up_to( maintenance_hardfork::CORE_1270 ), maint_time > HARDFORK_CORE_1270_TIME );
+      BOOST_CHECK_EQUAL( state.all_passed(), maint_time > HARDFORK_CORE_UNFILLABLE_BUYBACK_TIME );
+   }
+
+   // the state of the database follows next_maintenance_time, also when a block is popped
+   BOOST_CHECK( !db.get_hardfork_state().passed_up_to( maintenance_hardfork::CORE_1270 ) );
+   generate_blocks( HARDFORK_CORE_1270_TIME - db.get_global_properties().parameters.maintenance_interval );
+   while( db.get_dynamic_global_properties().next_maintenance_time <= HARDFORK_CORE_1270_TIME )
+   {
+      BOOST_CHECK( db.get_hardfork_state().before( maintenance_hardfork::CORE_1270 ) );
+      generate_blocks( db.get_dynamic_global_properties().next_maintenance_time );
+   }
+   BOOST_CHECK( db.get_hardfork_state().next_maintenance_time()
+                == db.get_dynamic_global_properties().next_maintenance_time );
+   BOOST_CHECK( db.get_hardfork_state().passed_up_to( maintenance_hardfork::CORE_1270 ) );
+
+   db.pop_block();
+   BOOST_CHECK( db.get_dynamic_global_properties().next_maintenance_time <= HARDFORK_CORE_1270_TIME );
+   BOOST_CHECK( db.get_hardfork_state().before( maintenance_hardfork::CORE_1270 ) );
+   BOOST_CHECK( !db.get_hardfork_state().passed_up_to( maintenance_hardfork::CORE_1270 ) );
+
+   generate_blocks( db.get_dynamic_global_properties().next_maintenance_time );
+   BOOST_CHECK( db.get_hardfork_state().passed_up_to( maintenance_hardfork::CORE_1270 ) );
+
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
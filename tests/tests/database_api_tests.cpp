@@ -24,6 +24,7 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <graphene/app/api.hpp>
 #include <graphene/app/database_api.hpp>
 #include <graphene/chain/hardfork.hpp>
 
@@ -1111,6 +1112,42 @@ BOOST_AUTO_TEST_CASE( lookup_vote_ids )
 
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE( get_maintenance_and_block_profiles )
+{ try {
+   graphene::app::database_api db_api(db);
+
+   generate_blocks( db.get_dynamic_global_properties().next_maintenance_time );
+   const uint32_t maintenance_block = db.head_block_num();
+   generate_blocks( db.get_dynamic_global_properties().next_maintenance_time );
+   generate_block();
+
+   auto maintenance_profiles = db_api.get_maintenance_profiles( 10 );
+   BOOST_REQUIRE_GE( maintenance_profiles.size(), 2u );
+   BOOST_CHECK_GT( maintenance_profiles[0].block_num, maintenance_block );
+   BOOST_CHECK_EQUAL( maintenance_profiles[1].block_num, maintenance_block );
+   const auto& phases = maintenance_profiles[0].phases;
+   BOOST_CHECK( std::any_of( phases.begin(), phases.end(), []( const phase_profile& p ) {
+      return p.name == "perform_account_maintenance";
+   }) );
+   BOOST_CHECK( std::any_of( phases.begin(), phases.end(), []( const phase_profile& p ) {
+      return p.name == "process_budget" && p.object_changes > 0;
+   }) );
+   BOOST_CHECK_EQUAL( db_api.get_maintenance_profiles( 1 ).size(), 1u );
+
+   auto block_profiles = db_api.get_block_profiles( 3 );
+   BOOST_REQUIRE_EQUAL( block_profiles.size(), 3u );
+   BOOST_CHECK_EQUAL( block_profiles[0].block_num, db.head_block_num() );
+   BOOST_CHECK_EQUAL( block_profiles[1].block_num, db.head_block_num() - 1 );
+   BOOST_CHECK( block_profiles[0].object_changes > 0 );
+
+   // profiling can be disabled
+   db.set_profile_history_size( 0, 0 );
+   BOOST_CHECK( db_api.get_maintenance_profiles( 10 ).empty() );
+   generate_block();
+   BOOST_CHECK( db_api.get_block_profiles( 10 ).empty() );
+
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE(get_account_limit_orders)
 { try {
 
@@ -1784,6 +1821,182 @@ BOOST_AUTO_TEST_CASE( asset_in_collateral )
    BOOST_CHECK_EQUAL( 0, assets[1].total_in_collateral->value );
    BOOST_CHECK_EQUAL( 1000, assets[1].total_backing_collateral->value );
 
+   graphene::app::asset_api asset_api( app );
+   auto stats = asset_api.get_debt_position_stats( "USDBIT" );
+   BOOST_CHECK_EQUAL( 1000, stats.total_debt.value );
+   BOOST_CHECK_EQUAL( 16500, stats.total_collateral.value );
+   BOOST_CHECK_EQUAL( 2u, stats.positions );
+   stats = asset_api.get_debt_position_stats( "DANBIT" );
+   BOOST_CHECK_EQUAL( 1000, stats.total_debt.value );
+   BOOST_CHECK_EQUAL( 15000, stats.total_collateral.value );
+   BOOST_CHECK_EQUAL( 1u, stats.positions );
+   stats = asset_api.get_debt_position_stats( std::string( static_cast<object_id_type>( btc_id ) ) );
+   BOOST_CHECK_EQUAL( 5, stats.total_debt.value );
+   BOOST_CHECK_EQUAL( 1000, stats.total_collateral.value );
+   BOOST_CHECK_EQUAL( 1u, stats.positions );
+   stats = asset_api.get_debt_position_stats( GRAPHENE_SYMBOL );
+   BOOST_CHECK_EQUAL( 0, stats.total_debt.value );
+   BOOST_CHECK_EQUAL( 0u, stats.positions );
+
+   // closing a position
+   BOOST_CHECK_EQUAL( 3u, db_api.get_margin_positions( "nathan" ).size() );
+   cover( nathan_id, btc.amount(5), bitusd.amount(1000) );
+   stats = asset_api.get_debt_position_stats( "BTC" );
+   BOOST_CHECK_EQUAL( 0, stats.total_debt.value );
+   BOOST_CHECK_EQUAL( 0, stats.total_collateral.value );
+   BOOST_CHECK_EQUAL( 0u, stats.positions );
+   BOOST_CHECK_EQUAL( 2u, db_api.get_margin_positions( "nathan" ).size() );
+   BOOST_CHECK_EQUAL( 1u, db_api.get_margin_positions( "dan" ).size() );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( order_book_cache )
+{ try {
+   ACTORS( (seller)(buyer) );
+
+   const asset_object& usd = create_user_issued_asset( "MYUSD" );
+   const asset_id_type usd_id = usd.id;
+   issue_uia( seller, usd.amount( 1000000 ) );
+   transfer( committee_account, buyer_id, asset( 1000000 ) );
+   generate_block();
+
+   graphene::app::database_api db_api( db, &( app.get_options() ) );
+
+   // bids sell MYUSD, asks sell CORE, no orders match
+   create_sell_order( seller_id, usd.amount( 100 ), asset( 300 ) );
+   create_sell_order( seller_id, usd.amount( 100 ), asset( 200 ) );
+   create_sell_order( buyer_id, asset( 100 ), usd.amount( 100 ) );
+
+   auto book = db_api.get_order_book( "MYUSD", GRAPHENE_SYMBOL, 10 );
+   BOOST_REQUIRE_EQUAL( book.bids.size(), 2u );
+   BOOST_REQUIRE_EQUAL( book.asks.size(), 1u );
+   const auto bids = book.bids;
+
+   // smaller requests and requests by asset ID are served from the same book
+   const string usd_id_string = string( object_id_type( usd_id ) );
+   auto top = db_api.get_order_book( usd_id_string, GRAPHENE_SYMBOL, 1 );
+   BOOST_CHECK_EQUAL( top.base, usd_id_string );
+   BOOST_REQUIRE_EQUAL( top.bids.size(), 1u );
+   BOOST_REQUIRE_EQUAL( top.asks.size(), 1u );
+   BOOST_CHECK_EQUAL( top.bids[0].price, bids[0].price );
+   BOOST_CHECK_EQUAL( top.bids[0].base, bids[0].base );
+
+   // the other direction of the market is a different book
+   auto inverted = db_api.get_order_book( GRAPHENE_SYMBOL, "MYUSD", 10 );
+   BOOST_CHECK_EQUAL( inverted.bids.size(), 1u );
+   BOOST_CHECK_EQUAL( inverted.asks.size(), 2u );
+
+   // a new order is visible right away, also in the other direction
+   const limit_order_id_type best_id = create_sell_order( seller_id, usd.amount( 100 ), asset( 150 ) )->id;
+   book = db_api.get_order_book( "MYUSD", GRAPHENE_SYMBOL, 10 );
+   BOOST_REQUIRE_EQUAL( book.bids.size(), 3u );
+   BOOST_CHECK( book.bids[0].price != bids[0].price );
+   BOOST_CHECK_EQUAL( book.bids[1].price, bids[0].price );
+   inverted = db_api.get_order_book( GRAPHENE_SYMBOL, "MYUSD", 10 );
+   BOOST_CHECK_EQUAL( inverted.asks.size(), 3u );
+
+   // filling the best order removes it again
+   create_sell_order( buyer_id, asset( 1000 ), usd.amount( 100 ) );
+   BOOST_CHECK( !db.find( best_id ) );
+   book = db_api.get_order_book( "MYUSD", GRAPHENE_SYMBOL, 10 );
+   BOOST_REQUIRE_EQUAL( book.bids.size(), 2u );
+   BOOST_CHECK_EQUAL( book.bids[0].price, bids[0].price );
+   generate_block();
+
+   // cancelling a pending order and dropping the pending transaction
+   const limit_order_object& worst = *db.get_index_type< limit_order_index >().indices().get< by_id >().rbegin();
+   cancel_limit_order( worst );
+   book = db_api.get_order_book( "MYUSD", GRAPHENE_SYMBOL, 10 );
+   BOOST_CHECK_EQUAL( book.bids.size() + book.asks.size(), 2u );
+   db.clear_pending();
+   book = db_api.get_order_book( "MYUSD", GRAPHENE_SYMBOL, 10 );
+   BOOST_CHECK_EQUAL( book.bids.size(), 2u );
+   BOOST_CHECK_EQUAL( book.asks.size(), 1u );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( market_depth_subscription )
+{ try {
+   ACTORS( (seller)(buyer) );
+
+   const asset_object& usd = create_user_issued_asset( "MYUSD" );
+   const asset_id_type usd_id = usd.id;
+   issue_uia( seller, usd.amount( 1000000 ) );
+   transfer( committee_account, buyer_id, asset( 1000000 ) );
+   generate_block();
+
+   graphene::app::database_api db_api( db, &( app.get_options() ) );
+
+   // the first two orders form one level, no orders match
+   create_sell_order( seller_id, usd.amount( 100 ), asset( 200 ) );
+   create_sell_order( seller_id, usd.amount( 50 ), asset( 100 ) );
+   const limit_order_id_type worst_id = create_sell_order( seller_id, usd.amount( 100 ), asset( 300 ) )->id;
+   create_sell_order( buyer_id, asset( 100 ), usd.amount( 100 ) );
+
+   // pending orders are not published yet
+   auto depth = db_api.get_market_depth( "MYUSD", GRAPHENE_SYMBOL, 10 );
+   BOOST_CHECK( depth.bids.empty() );
+   BOOST_CHECK( depth.asks.empty() );
+   const uint64_t sequence = depth.sequence;
+
+   vector< graphene::app::market_depth > updates;
+   db_api.subscribe_to_market_depth( [&]( const variant& v ) {
+      updates.push_back( v.as< graphene::app::market_depth >( GRAPHENE_MAX_NESTED_OBJECTS ) );
+   }, "MYUSD", GRAPHENE_SYMBOL );
+
+   generate_block();
+   fc::usleep(fc::milliseconds(200)); // sleep a while to execute callback in another thread
+
+   depth = db_api.get_market_depth( "MYUSD", GRAPHENE_SYMBOL, 10 );
+   BOOST_CHECK_EQUAL( depth.sequence, sequence + 1 );
+   BOOST_CHECK_EQUAL( depth.block_num, db.head_block_num() );
+   BOOST_REQUIRE_EQUAL( depth.bids.size(), 2u );
+   BOOST_CHECK( depth.bids[0].sell_price == usd.amount( 100 ) / asset( 200 ) );
+   BOOST_CHECK_EQUAL( depth.bids[0].for_sale.value, 150 );
+   BOOST_CHECK_EQUAL( depth.bids[1].for_sale.value, 100 );
+   BOOST_REQUIRE_EQUAL( depth.asks.size(), 1u );
+   BOOST_CHECK_EQUAL( depth.asks[0].for_sale.value, 100 );
+
+   BOOST_REQUIRE_EQUAL( updates.size(), 1u );
+   BOOST_CHECK_EQUAL( updates[0].sequence, depth.sequence );
+   BOOST_CHECK( updates[0].base == usd_id );
+   BOOST_CHECK_EQUAL( updates[0].bids.size(), 2u );
+   BOOST_CHECK_EQUAL( updates[0].asks.size(), 1u );
+
+   // partially filling the best level only publishes that level
+   create_sell_order( buyer_id, asset( 100 ), usd.amount( 50 ) );
+   generate_block();
+   fc::usleep(fc::milliseconds(200)); // sleep a while to execute callback in another thread
+
+   BOOST_REQUIRE_EQUAL( updates.size(), 2u );
+   BOOST_CHECK_EQUAL( updates[1].sequence, updates[0].sequence + 1 );
+   BOOST_REQUIRE_EQUAL( updates[1].bids.size(), 1u );
+   BOOST_CHECK_EQUAL( updates[1].bids[0].for_sale.value, 100 );
+   BOOST_CHECK( updates[1].asks.empty() );
+
+   // blocks without changes in the market publish nothing
+   generate_block();
+   fc::usleep(fc::milliseconds(200)); // sleep a while to execute callback in another thread
+   BOOST_CHECK_EQUAL( updates.size(), 2u );
+
+   // a removed level is published with nothing for sale
+   cancel_limit_order( worst_id( db ) );
+   generate_block();
+   fc::usleep(fc::milliseconds(200)); // sleep a while to execute callback in another thread
+
+   BOOST_REQUIRE_EQUAL( updates.size(), 3u );
+   BOOST_REQUIRE_EQUAL( updates[2].bids.size(), 1u );
+   BOOST_CHECK_EQUAL( updates[2].bids[0].for_sale.value, 0 );
+   depth = db_api.get_market_depth( "MYUSD", GRAPHENE_SYMBOL, 10 );
+   BOOST_CHECK_EQUAL( depth.sequence, updates[2].sequence );
+   BOOST_CHECK_EQUAL( depth.bids.size(), 1u );
+
+   db_api.unsubscribe_from_market_depth( "MYUSD", GRAPHENE_SYMBOL );
+   create_sell_order( seller_id, usd.amount( 100 ), asset( 400 ) );
+   generate_block();
+   fc::usleep(fc::milliseconds(200)); // sleep a while to execute callback in another thread
+   BOOST_CHECK_EQUAL( updates.size(), 3u );
+
 } FC_LOG_AND_RETHROW() }
 
 BOOST_AUTO_TEST_SUITE_END()
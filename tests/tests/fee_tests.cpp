@@ -714,6 +714,67 @@ BOOST_AUTO_TEST_CASE( account_create_fee_scaling )
    BOOST_CHECK_EQUAL(db.get_global_properties().parameters.get_current_fees().get<account_create_operation>().basic_fee, 1u);
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE( deferred_fee_processing )
+{ try {
+   const auto& stats_idx = db.get_index_type<account_stats_index>().indices().get<by_pending_fees>();
+   auto accounts_with_pending_fees = [&stats_idx]() -> size_t {
+      return std::distance( stats_idx.lower_bound( true ), stats_idx.end() );
+   };
+   auto lifetime_fees_paid = [this]( account_id_type account ) {
+      return account(db).statistics(db).lifetime_fees_paid.value;
+   };
+
+   ACTORS((alice));
+   const uint32_t payers = GRAPHENE_MAX_FEE_PROCESSING_ACCOUNTS_PER_BLOCK + 500;
+   vector<account_id_type> payer_ids;
+   for( uint32_t i = 0; i < payers; ++i )
+      payer_ids.push_back( create_account( "payer" + fc::to_string(i) ).id );
+
+   enable_fees();
+   const int64_t fee = db.current_fee_schedule().calculate_fee( transfer_operation() ).amount.value;
+
+   // before the hardfork, fees are paid out by maintenance
+   transfer( committee_account, alice_id, asset(10 * fee) );
+   transfer( alice_id, committee_account, asset(1) );
+   BOOST_CHECK_EQUAL( accounts_with_pending_fees(), 2u );
+   generate_blocks( db.get_dynamic_global_properties().next_maintenance_time );
+   BOOST_CHECK_EQUAL( accounts_with_pending_fees(), 0u );
+   BOOST_CHECK_EQUAL( lifetime_fees_paid( alice_id ), fee );
+
+   generate_blocks( HARDFORK_CORE_DEFERRED_FEES_TIME );
+   generate_blocks( db.get_dynamic_global_properties().next_maintenance_time );
+
+   for( uint32_t i = 0; i < payers; ++i )
+   {
+      transfer( committee_account, payer_ids[i], asset(2 * fee) );
+      transfer( payer_ids[i], committee_account, asset(1) );
+      if( i % 500 == 499 )
+         generate_block();
+   }
+   generate_block();
+   BOOST_CHECK_EQUAL( accounts_with_pending_fees(), payers + 1 );
+
+   // the maintenance block pays out the first accounts in the order of their names
+   generate_blocks( db.get_dynamic_global_properties().next_maintenance_time );
+   BOOST_CHECK_EQUAL( accounts_with_pending_fees(), payers + 1 - GRAPHENE_MAX_FEE_PROCESSING_ACCOUNTS_PER_BLOCK );
+   BOOST_REQUIRE( db.get_dynamic_global_properties().next_fee_processing_account.valid() );
+   BOOST_CHECK_EQUAL( lifetime_fees_paid( payer_ids[1] ), fee );
+
+   // fees of accounts that were already paid out wait for the next maintenance
+   transfer( committee_account, payer_ids[0], asset(2 * fee) );
+   transfer( payer_ids[0], committee_account, asset(1) );
+   generate_block();
+   BOOST_CHECK_EQUAL( accounts_with_pending_fees(), 2u );
+   BOOST_CHECK( !db.get_dynamic_global_properties().next_fee_processing_account.valid() );
+   for( const account_id_type& payer : payer_ids )
+      BOOST_CHECK_EQUAL( lifetime_fees_paid( payer ), fee );
+
+   generate_blocks( db.get_dynamic_global_properties().next_maintenance_time );
+   BOOST_CHECK_EQUAL( accounts_with_pending_fees(), 0u );
+   BOOST_CHECK_EQUAL( lifetime_fees_paid( payer_ids[0] ), 2 * fee );
+
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE( fee_refund_test )
 {
    try
@@ -25,6 +25,7 @@
 #include <boost/test/unit_test.hpp>
 
 #include <graphene/chain/asset_object.hpp>
+#include <graphene/chain/market_object.hpp>
 #include <graphene/app/api.hpp>
 
 #include "../common/database_fixture.hpp"
@@ -58,4 +59,78 @@ BOOST_AUTO_TEST_CASE(api_limit_get_grouped_limit_orders) {
     throw;
    }
 }
+BOOST_AUTO_TEST_CASE(grouped_limit_orders_by_price_bucket)
+{ try {
+   // tracked groups are 10 and 100 by default
+   graphene::app::orders_api orders_api(app);
+
+   ACTORS( (seller) );
+   const asset_id_type usd_id = create_user_issued_asset( "USD" ).id;
+   transfer( committee_account, seller_id, asset( 1000000 ) );
+   const std::string core_str = std::string( static_cast<object_id_type>(asset_id_type()) );
+   const std::string usd_str = std::string( static_cast<object_id_type>(usd_id) );
+
+   // CORE per USD, 0.05% above 1, 1, 0.05% below 1 and 11% above 1
+   const limit_order_id_type a_id = create_sell_order( seller_id, asset(10000), asset(10000, usd_id) )->id;
+   const limit_order_id_type b_id = create_sell_order( seller_id, asset(10000), asset(10005, usd_id) )->id;
+   const limit_order_id_type c_id = create_sell_order( seller_id, asset(10000), asset(9995, usd_id) )->id;
+   const limit_order_id_type d_id = create_sell_order( seller_id, asset(10000), asset(9000, usd_id) )->id;
+   const price a_price = a_id(db).sell_price;
+   generate_block();
+
+   for( uint16_t group : { 10, 100 } )
+   {
+      vector< limit_order_group > groups = orders_api.get_grouped_limit_orders( core_str, usd_str, group, {}, 100 );
+      BOOST_REQUIRE_EQUAL( groups.size(), 3u );
+      BOOST_CHECK( groups[0].min_price == d_id(db).sell_price );
+      BOOST_CHECK( groups[0].max_price == d_id(db).sell_price );
+      BOOST_CHECK_EQUAL( groups[0].total_for_sale.value, 10000 );
+      BOOST_CHECK( groups[1].min_price == a_price );
+      BOOST_CHECK( groups[1].max_price == c_id(db).sell_price );
+      BOOST_CHECK_EQUAL( groups[1].total_for_sale.value, 20000 );
+      BOOST_CHECK( groups[2].min_price == b_id(db).sell_price );
+      BOOST_CHECK_EQUAL( groups[2].total_for_sale.value, 10000 );
+
+      // starting with the group containing the given price
+      groups = orders_api.get_grouped_limit_orders( core_str, usd_str, group, a_price, 100 );
+      BOOST_REQUIRE_EQUAL( groups.size(), 2u );
+      BOOST_CHECK_EQUAL( groups[0].total_for_sale.value, 20000 );
+
+      groups = orders_api.get_grouped_limit_orders( core_str, usd_str, group, {}, 1 );
+      BOOST_REQUIRE_EQUAL( groups.size(), 1u );
+
+      // the other side of the market is empty
+      BOOST_CHECK( orders_api.get_grouped_limit_orders( usd_str, core_str, group, {}, 100 ).empty() );
+   }
+   BOOST_CHECK( orders_api.get_grouped_limit_orders( core_str, usd_str, 20, {}, 100 ).empty() );
+
+   // a partially filled order stays in its group
+   issue_uia( seller_id, asset( 100000, usd_id ) );
+   create_sell_order( seller_id, asset(4000, usd_id), asset(4000) );
+   vector< limit_order_group > groups = orders_api.get_grouped_limit_orders( core_str, usd_str, 10, {}, 100 );
+   BOOST_REQUIRE_EQUAL( groups.size(), 3u );
+   BOOST_CHECK_LT( d_id(db).for_sale.value, 10000 );
+   BOOST_CHECK_EQUAL( groups[0].total_for_sale.value, d_id(db).for_sale.value );
+
+   // the price range of a group shrinks with its orders, groups get removed with their last order
+   cancel_limit_order( c_id(db) );
+   groups = orders_api.get_grouped_limit_orders( core_str, usd_str, 10, {}, 100 );
+   BOOST_REQUIRE_EQUAL( groups.size(), 3u );
+   BOOST_CHECK_EQUAL( groups[1].total_for_sale.value, 10000 );
+   BOOST_CHECK( groups[1].min_price == a_price );
+   BOOST_CHECK( groups[1].max_price == a_price );
+   cancel_limit_order( a_id(db) );
+   groups = orders_api.get_grouped_limit_orders( core_str, usd_str, 10, {}, 100 );
+   BOOST_REQUIRE_EQUAL( groups.size(), 2u );
+   BOOST_CHECK_EQUAL( groups[1].total_for_sale.value, 10000 );
+
+   // changes get undone with the pending transactions
+   generate_block();
+   cancel_limit_order( b_id(db) );
+   BOOST_CHECK_EQUAL( orders_api.get_grouped_limit_orders( core_str, usd_str, 10, {}, 100 ).size(), 1u );
+   db.clear_pending();
+   BOOST_CHECK_EQUAL( orders_api.get_grouped_limit_orders( core_str, usd_str, 10, {}, 100 ).size(), 2u );
+
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -1890,4 +1890,250 @@ BOOST_AUTO_TEST_CASE(target_cr_test_call_limit_after_hf1270)
 } FC_LOG_AND_RETHROW() }
 
 
+/***
+ * The per-market order books have to contain the same orders in the same order as the global by_price index
+ */
+BOOST_AUTO_TEST_CASE(limit_order_book_index_test)
+{ try {
+   ACTORS((seller)(buyer));
+
+   const asset_object& usd = create_user_issued_asset( "MYUSD" );
+   const asset_object& eur = create_user_issued_asset( "MYEUR" );
+   const asset_id_type usd_id = usd.id;
+   const asset_id_type eur_id = eur.id;
+   const asset_id_type core_id;
+
+   transfer( committee_account, seller_id, asset( 10000000 ) );
+   transfer( committee_account, buyer_id, asset( 10000000 ) );
+   issue_uia( seller, usd.amount( 10000000 ) );
+   issue_uia( buyer, eur.amount( 10000000 ) );
+
+   // orders with equal prices in different amounts, and non-matching orders on both sides of two markets
+   create_sell_order( seller_id, asset( 1000 ), usd.amount( 500 ) );
+   const limit_order_id_type first_id = create_sell_order( seller_id, asset( 100 ), usd.amount( 50 ) )->id;
+   const limit_order_id_type second_id = create_sell_order( seller_id, asset( 200 ), usd.amount( 100 ) )->id;
+   create_sell_order( seller_id, asset( 300 ), usd.amount( 100 ) );
+   create_sell_order( seller_id, usd.amount( 100 ), asset( 400 ) );
+   create_sell_order( seller_id, usd.amount( 100 ), asset( 500 ) );
+   create_sell_order( buyer_id, eur.amount( 100 ), asset( 400 ) );
+   create_sell_order( buyer_id, asset( 400 ), eur.amount( 200 ) );
+   generate_block();
+
+   auto check_books = [&]()
+   {
+      const auto& order_books = db.get_index_type< primary_index< limit_order_index > >()
+                                   .get_secondary_index< limit_order_book_index >();
+      const auto& by_price_idx = db.get_index_type< limit_order_index >().indices().get< by_price >();
+      size_t total = 0;
+      for( const auto& market : { std::make_pair( core_id, usd_id ), std::make_pair( usd_id, core_id ),
+                                  std::make_pair( core_id, eur_id ), std::make_pair( eur_id, core_id ),
+                                  std::make_pair( usd_id, eur_id ) } )
+      {
+         const auto& side = order_books.get_orders( market.first, market.second );
+         vector< limit_order_id_type > from_book;
+         for( const auto& entry : side )
+            from_book.push_back( entry.second->id );
+         vector< limit_order_id_type > from_index;
+         auto itr = by_price_idx.lower_bound( price::max( market.first, market.second ) );
+         auto end = by_price_idx.upper_bound( price::min( market.first, market.second ) );
+         for( ; itr != end; ++itr )
+            from_index.push_back( itr->id );
+         BOOST_CHECK( from_book == from_index );
+         total += from_book.size();
+      }
+      BOOST_CHECK_EQUAL( total, by_price_idx.size() );
+   };
+
+   check_books();
+
+   // the best price comes first, orders with the same price keep arrival order
+   const auto& core_usd = db.get_index_type< primary_index< limit_order_index > >()
+                             .get_secondary_index< limit_order_book_index >().get_orders( core_id, usd_id );
+   BOOST_REQUIRE_EQUAL( core_usd.size(), 4u );
+   auto itr = core_usd.begin();
+   BOOST_CHECK( itr->second->sell_price == asset( 300 ) / usd.amount( 100 ) );
+   ++itr;
+   BOOST_CHECK( itr->second->sell_price == asset( 1000 ) / usd.amount( 500 ) );
+   ++itr;
+   BOOST_REQUIRE( itr != core_usd.end() );
+   BOOST_CHECK( itr->second->id == first_id );
+   ++itr;
+   BOOST_REQUIRE( itr != core_usd.end() );
+   BOOST_CHECK( itr->second->id == second_id );
+
+   // fill and partially fill the best orders, then cancel one
+   create_sell_order( buyer_id, eur.amount( 10 ), asset( 10 ) );
+   create_sell_order( seller_id, usd.amount( 550 ), asset( 1000 ) );
+   BOOST_CHECK_EQUAL( core_usd.size(), 3u );
+   check_books();
+   cancel_limit_order( second_id( db ) );
+   BOOST_CHECK_EQUAL( core_usd.size(), 2u );
+   check_books();
+
+   // undo restores the books too
+   generate_block();
+   check_books();
+   db.pop_block();
+   BOOST_CHECK_EQUAL( core_usd.size(), 4u );
+   check_books();
+
+} FC_LOG_AND_RETHROW() }
+
+/***
+ * The margin call trigger index has to provide the same least collateralized call order as the by_collateral index
+ */
+BOOST_AUTO_TEST_CASE(margin_call_trigger_index_test)
+{ try {
+   auto mi = db.get_global_properties().parameters.maintenance_interval;
+   generate_blocks( HARDFORK_CORE_1270_TIME - mi );
+   generate_blocks( db.get_dynamic_global_properties().next_maintenance_time );
+   set_expiration( db, trx );
+
+   ACTORS((seller)(borrower)(borrower2)(borrower3)(feedproducer));
+
+   const auto& bitusd = create_bitasset( "USDBIT", feedproducer_id );
+   const auto& biteur = create_bitasset( "EURBIT", feedproducer_id );
+   const auto& core   = asset_id_type()( db );
+   const asset_id_type usd_id = bitusd.id;
+   const asset_id_type eur_id = biteur.id;
+
+   int64_t init_balance( 1000000 );
+   transfer( committee_account, borrower_id, asset( init_balance ) );
+   transfer( committee_account, borrower2_id, asset( init_balance ) );
+   transfer( committee_account, borrower3_id, asset( init_balance ) );
+   update_feed_producers( bitusd, { feedproducer.id } );
+   update_feed_producers( biteur, { feedproducer.id } );
+
+   price_feed current_feed;
+   current_feed.maintenance_collateral_ratio = 1750;
+   current_feed.maximum_short_squeeze_ratio = 1100;
+   current_feed.settlement_price = bitusd.amount( 1 ) / core.amount( 5 );
+   publish_feed( bitusd, feedproducer, current_feed );
+   current_feed.settlement_price = biteur.amount( 1 ) / core.amount( 5 );
+   publish_feed( biteur, feedproducer, current_feed );
+
+   auto check_least_collateralized = [&]( asset_id_type debt_asset )
+   {
+      const call_order_object* least = db.get_index_type< primary_index< call_order_index > >()
+                                          .get_secondary_index< margin_call_trigger_index >()
+                                          .get_least_collateralized( debt_asset );
+      const auto& call_collateral_index = db.get_index_type< call_order_index >().indices().get< by_collateral >();
+      auto itr = call_collateral_index.lower_bound( price::min( asset_id_type(), debt_asset ) );
+      if( itr == call_collateral_index.end() || itr->debt_type() != debt_asset )
+         BOOST_CHECK( least == nullptr );
+      else
+      {
+         BOOST_REQUIRE( least != nullptr );
+         BOOST_CHECK( least->id == itr->id );
+      }
+   };
+   auto check_all = [&]()
+   {
+      check_least_collateralized( usd_id );
+      check_least_collateralized( eur_id );
+   };
+
+   check_all();
+
+   // 300%, 310% and 320% collateral in USD, the EUR positions are tracked separately
+   const call_order_id_type call_id = borrow( borrower, bitusd.amount( 1000 ), asset( 15000 ) )->id;
+   const call_order_id_type call2_id = borrow( borrower2, bitusd.amount( 1000 ), asset( 15500 ) )->id;
+   const call_order_id_type call3_id = borrow( borrower3, bitusd.amount( 1000 ), asset( 16000 ) )->id;
+   borrow( borrower2, biteur.amount( 1000 ), asset( 20000 ) );
+   borrow( borrower3, biteur.amount( 1000 ), asset( 25000 ) );
+   check_all();
+   BOOST_CHECK( db.get_index_type< primary_index< call_order_index > >()
+                   .get_secondary_index< margin_call_trigger_index >()
+                   .get_least_collateralized( usd_id )->id == call_id );
+
+   generate_block();
+
+   // covering debt moves the least collateralized position to the back
+   cover( borrower, bitusd.amount( 500 ), asset( 1000 ) );
+   check_all();
+   BOOST_CHECK( db.get_index_type< primary_index< call_order_index > >()
+                   .get_secondary_index< margin_call_trigger_index >()
+                   .get_least_collateralized( usd_id )->id == call2_id );
+
+   // margin call the least collateralized position, then close another one completely
+   transfer( borrower3, seller, bitusd.amount( 1000 ) );
+   current_feed.settlement_price = bitusd.amount( 1 ) / core.amount( 10 );
+   publish_feed( bitusd, feedproducer, current_feed );
+   check_all();
+   create_sell_order( seller, bitusd.amount( 700 ), core.amount( 7700 ) );
+   check_all();
+   BOOST_CHECK( db.get_index_type< primary_index< call_order_index > >()
+                   .get_secondary_index< margin_call_trigger_index >()
+                   .get_least_collateralized( usd_id )->id == call3_id );
+   cover( borrower, bitusd.amount( 500 ), asset( 14000 ) );
+   check_all();
+   BOOST_CHECK( !db.find( call_id ) );
+
+   // undo restores the index
+   generate_block();
+   db.pop_block();
+   check_all();
+   BOOST_CHECK( db.find( call_id ) );
+   BOOST_CHECK( db.find( call2_id ) );
+   BOOST_CHECK( db.find( call3_id ) );
+
+} FC_LOG_AND_RETHROW() }
+
+/***
+ * Limit orders expiring in the same block are refunded at once, the virtual operations keep the order of expiration
+ */
+BOOST_AUTO_TEST_CASE(expired_limit_orders_test)
+{ try {
+   auto mi = db.get_global_properties().parameters.maintenance_interval;
+   generate_blocks( HARDFORK_CORE_606_TIME - mi );
+   generate_blocks( db.get_dynamic_global_properties().next_maintenance_time );
+   set_expiration( db, trx );
+
+   ACTORS((seller)(seller2));
+
+   const asset_object& usd = create_user_issued_asset( "MYUSD" );
+   const asset_id_type usd_id = usd.id;
+   const asset_id_type core_id;
+
+   transfer( committee_account, seller_id, asset( 1000000 ) );
+   transfer( committee_account, seller2_id, asset( 1000000 ) );
+   issue_uia( seller, usd.amount( 1000000 ) );
+   issue_uia( seller2, usd.amount( 1000000 ) );
+
+   // non-matching orders of both sellers on both sides, interleaved with orders expiring later
+   const fc::time_point_sec expiration = db.head_block_time() + 60;
+   vector< limit_order_id_type > expiring;
+   for( int64_t i = 0; i < 10; ++i )
+   {
+      const account_object& who = ( i % 2 == 0 ? seller_id( db ) : seller2_id( db ) );
+      expiring.push_back( create_sell_order( who, asset( 100 + i ), usd.amount( 1000 ), expiration )->id );
+      expiring.push_back( create_sell_order( who, usd.amount( 100 + i ), asset( 1000 ), expiration )->id );
+      create_sell_order( who, asset( 100 ), usd.amount( 1000 ), expiration + 600 );
+   }
+   BOOST_CHECK_EQUAL( seller_id( db ).statistics( db ).total_core_in_orders.value, 500 + 100 + 102 + 104 + 106 + 108 );
+
+   vector< limit_order_id_type > cancelled;
+   auto connection = db.applied_block.connect( [&]( const signed_block& ) {
+      for( const auto& oh : db.get_applied_operations() )
+         if( oh.valid() && oh->op.is_type< limit_order_cancel_operation >() )
+            cancelled.push_back( oh->op.get< limit_order_cancel_operation >().order );
+   });
+   generate_blocks( expiration );
+   generate_block();
+   connection.disconnect();
+
+   BOOST_CHECK( cancelled == expiring );
+   for( const auto& id : expiring )
+      BOOST_CHECK( !db.find( id ) );
+   BOOST_CHECK_EQUAL( db.get_index_type< limit_order_index >().indices().size(), 10u );
+
+   BOOST_CHECK_EQUAL( seller_id( db ).statistics( db ).total_core_in_orders.value, 500 );
+   BOOST_CHECK_EQUAL( seller2_id( db ).statistics( db ).total_core_in_orders.value, 500 );
+   BOOST_CHECK_EQUAL( get_balance( seller_id, core_id ), 1000000 - 500 );
+   BOOST_CHECK_EQUAL( get_balance( seller2_id, core_id ), 1000000 - 500 );
+   BOOST_CHECK_EQUAL( get_balance( seller_id, usd_id ), 1000000 );
+   BOOST_CHECK_EQUAL( get_balance( seller2_id, usd_id ), 1000000 );
+
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
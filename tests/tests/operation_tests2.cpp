@@ -1233,6 +1233,94 @@ BOOST_AUTO_TEST_CASE( worker_pay_test )
    BOOST_CHECK_EQUAL(worker_id_type()(db).worker.get<vesting_balance_worker_type>().balance(db).balance.amount.value, 0);
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE( simulate_budget_test )
+{ try {
+   INVOKE(worker_create_test);
+   GET_ACTOR(nathan);
+   generate_blocks(db.get_dynamic_global_properties().next_maintenance_time);
+   transfer(committee_account, nathan_id, asset(100000));
+
+   {
+      account_update_operation op;
+      op.account = nathan_id;
+      op.new_options = nathan_id(db).options;
+      op.new_options->votes.insert(worker_id_type()(db).vote_for);
+      trx.operations.push_back(op);
+      PUSH_TX( db, trx, ~0 );
+      trx.clear();
+   }
+   {
+      asset_reserve_operation op;
+      op.payer = account_id_type();
+      op.amount_to_reserve = asset(GRAPHENE_MAX_SHARE_SUPPLY/2);
+      trx.operations.push_back(op);
+      PUSH_TX( db, trx, ~0 );
+      trx.clear();
+   }
+
+   // the worker is paid from the maintenance after the vote was counted
+   generate_blocks(db.get_dynamic_global_properties().next_maintenance_time);
+   BOOST_CHECK_EQUAL(worker_id_type()(db).worker.get<vesting_balance_worker_type>().balance(db).balance.amount.value, 1000);
+
+   // stop right before the next maintenance block
+   const auto next_maintenance_time = db.get_dynamic_global_properties().next_maintenance_time;
+   generate_blocks(next_maintenance_time - db.get_global_properties().parameters.block_interval);
+
+   auto count_budget_records = [this]() {
+      size_t count = 0;
+      db.get_index_type< simple_index<budget_record_object> >().inspect_all_objects( [&count]( const object& ) {
+         ++count;
+      });
+      return count;
+   };
+   const size_t budget_records = count_budget_records();
+   const object_id_type next_budget_record_id = db.get_index_type< simple_index<budget_record_object> >().get_next_id();
+   const auto head_time = db.head_block_time();
+   const share_type core_supply = db.get_core_dynamic_data().current_supply;
+   const vector<char> dpo_before = fc::raw::pack( db.get_dynamic_global_properties() );
+   const vector<char> core_dd_before = fc::raw::pack( db.get_core_dynamic_data() );
+   const vector<char> worker_before = fc::raw::pack( worker_id_type()(db) );
+   const size_t block_profiles = db.get_block_profiler().get_profiles( 100 ).size();
+   const size_t maintenance_profiles = db.get_maintenance_profiler().get_profiles( 100 ).size();
+
+   budget_simulation sim = db.simulate_budget();
+   BOOST_CHECK( sim.time == next_maintenance_time );
+   BOOST_REQUIRE_EQUAL( sim.worker_pay.size(), 1u );
+   BOOST_CHECK( sim.worker_pay[0].first == worker_id_type() );
+   BOOST_CHECK_EQUAL( sim.worker_pay[0].second.value, 1000 );
+   BOOST_CHECK_EQUAL( sim.record.leftover_worker_funds.value,
+                      sim.record.worker_budget.value - 1000 );
+
+   // nothing was changed, not even temporarily, so neither the secondary indexes nor the profiles saw anything
+   BOOST_CHECK_EQUAL(worker_id_type()(db).worker.get<vesting_balance_worker_type>().balance(db).balance.amount.value, 1000);
+   BOOST_CHECK_EQUAL( count_budget_records(), budget_records );
+   BOOST_CHECK( db.get_index_type< simple_index<budget_record_object> >().get_next_id() == next_budget_record_id );
+   BOOST_CHECK( db.head_block_time() == head_time );
+   BOOST_CHECK( db.get_dynamic_global_properties().next_maintenance_time == next_maintenance_time );
+   BOOST_CHECK( db.get_hardfork_state().next_maintenance_time() == next_maintenance_time );
+   BOOST_CHECK_EQUAL( db.get_core_dynamic_data().current_supply.value, core_supply.value );
+   BOOST_CHECK( fc::raw::pack( db.get_dynamic_global_properties() ) == dpo_before );
+   BOOST_CHECK( fc::raw::pack( db.get_core_dynamic_data() ) == core_dd_before );
+   BOOST_CHECK( fc::raw::pack( worker_id_type()(db) ) == worker_before );
+   BOOST_CHECK_EQUAL( db.get_block_profiler().get_profiles( 100 ).size(), block_profiles );
+   BOOST_CHECK_EQUAL( db.get_maintenance_profiler().get_profiles( 100 ).size(), maintenance_profiles );
+
+   // the actual maintenance pays the same, the witness budget also covers the maintenance block itself
+   generate_block();
+   BOOST_CHECK( db.get_dynamic_global_properties().next_maintenance_time > next_maintenance_time );
+   BOOST_CHECK_EQUAL(worker_id_type()(db).worker.get<vesting_balance_worker_type>().balance(db).balance.amount.value, 2000);
+   const budget_record_object* last_record = nullptr;
+   db.get_index_type< simple_index<budget_record_object> >().inspect_all_objects( [&last_record]( const object& o ) {
+      last_record = static_cast<const budget_record_object*>( &o );
+   });
+   BOOST_REQUIRE( last_record != nullptr );
+   BOOST_CHECK( last_record->time == sim.time );
+   BOOST_CHECK_EQUAL( last_record->record.time_since_last_budget, sim.record.time_since_last_budget );
+   BOOST_CHECK_EQUAL( last_record->record.requested_witness_budget.value, sim.record.requested_witness_budget.value );
+   BOOST_CHECK_EQUAL( last_record->record.worker_budget.value, sim.record.worker_budget.value );
+   BOOST_CHECK_EQUAL( last_record->record.leftover_worker_funds.value, sim.record.leftover_worker_funds.value );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE( refund_worker_test )
 {try{
    ACTOR(nathan);
@@ -2291,4 +2379,72 @@ BOOST_AUTO_TEST_CASE( buyback )
    } FC_LOG_AND_RETHROW()
 }
 
+BOOST_AUTO_TEST_CASE( unfillable_buyback_orders )
+{ try {
+   ACTORS( (alice)(izzy)(philbin) );
+   upgrade_to_lifetime_member(philbin_id);
+
+   // the maintenance interval which ends at the hardfork time is still processed with the old rules
+   generate_blocks( HARDFORK_CORE_UNFILLABLE_BUYBACK_TIME - db.get_global_properties().parameters.maintenance_interval );
+   generate_block();
+   set_expiration( db, trx );
+
+   auto create_buyback_account = [&]( const string& name, asset_id_type asset_to_buy ) -> account_id_type {
+      buyback_account_options bbo;
+      bbo.asset_to_buy = asset_to_buy;
+      bbo.asset_to_buy_issuer = izzy_id;
+      bbo.markets.emplace( asset_id_type() );
+      account_create_operation create_op = make_account( name );
+      create_op.registrar = philbin_id;
+      create_op.extensions.value.buyback_options = bbo;
+      create_op.owner = authority::null_authority();
+      create_op.active = authority::null_authority();
+
+      signed_transaction tx;
+      tx.operations.push_back( create_op );
+      set_expiration( db, tx );
+      sign( tx, izzy_private_key );
+      sign( tx, philbin_private_key );
+      return PUSH_TX( db, tx ).operation_results.back().get< object_id_type >();
+   };
+
+   asset_id_type buya_id = create_user_issued_asset( "BUYA", izzy_id(db), 0 ).id;
+   asset_id_type buyb_id = create_user_issued_asset( "BUYB", izzy_id(db), 0 ).id;
+   account_id_type rexa_id = create_buyback_account( "rexa", buya_id );
+   account_id_type rexb_id = create_buyback_account( "rexb", buyb_id );
+
+   // Alice sells 100 BUYA for 1000 CORE, nobody sells BUYB
+   issue_uia( alice_id, asset( 1000, buya_id ) );
+   limit_order_id_type order_id = create_sell_order( alice_id, asset( 100, buya_id ), asset( 1000 ) )->id;
+
+   fund( rexa_id(db), asset( 250 ) );
+   fund( rexb_id(db), asset( 500 ) );
+   object_id_type next_order_id = db.get_index_type<limit_order_index>().get_next_id();
+
+   BOOST_REQUIRE( db.get_dynamic_global_properties().next_maintenance_time == HARDFORK_CORE_UNFILLABLE_BUYBACK_TIME );
+   generate_blocks( db.get_dynamic_global_properties().next_maintenance_time );
+
+   BOOST_CHECK_EQUAL( order_id(db).for_sale.value, 75 );
+   BOOST_CHECK_EQUAL( get_balance( rexa_id, asset_id_type() ), 0 );
+   BOOST_CHECK_EQUAL( get_balance( rexa_id, buya_id ), 25 );
+   // before the hardfork, the order of rexb is created and cancelled right away
+   BOOST_CHECK_EQUAL( get_balance( rexb_id, asset_id_type() ), 500 );
+   BOOST_CHECK( db.get_index_type<limit_order_index>().get_next_id().instance() == next_order_id.instance() + 2 );
+
+   generate_block();
+   set_expiration( db, trx );
+   fund( rexa_id(db), asset( 250 ) );
+   next_order_id = db.get_index_type<limit_order_index>().get_next_id();
+
+   generate_blocks( db.get_dynamic_global_properties().next_maintenance_time );
+
+   BOOST_CHECK_EQUAL( order_id(db).for_sale.value, 50 );
+   BOOST_CHECK_EQUAL( get_balance( rexa_id, asset_id_type() ), 0 );
+   BOOST_CHECK_EQUAL( get_balance( rexa_id, buya_id ), 50 );
+   // after the hardfork, the order of rexb could not be filled, so it was not created
+   BOOST_CHECK_EQUAL( get_balance( rexb_id, asset_id_type() ), 500 );
+   BOOST_CHECK( db.get_index_type<limit_order_index>().get_next_id().instance() == next_order_id.instance() + 1 );
+
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()